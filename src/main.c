@@ -10,7 +10,10 @@
 
 int main(void)
 {
-    platform_init();
+    if (platform_init() != 0)
+    {
+        return 1;
+    }
     test_init();
     test_run();
 
@@ -5,7 +5,9 @@
 * @author Zarko Milojicic
 */
 
+#if !defined(PORT_TM4C123) && !defined(PORT_LINUX)
 #define PORT_TM4C123
+#endif
 
 #ifndef PLATFORM_H
 #define  PLATFORM_H
@@ -14,6 +16,8 @@
 extern "C" {
 #endif
 
+#include "tmp006/tmp006.h"
+
 #ifdef PORT_TM4C123
 #include "port/tm4c123/tm4c_init.h" 
 
@@ -24,6 +28,10 @@ extern "C" {
 #define PRINTF(fmt,...)   UARTprintf((fmt), ##__VA_ARGS__)
 #else
 
+#ifdef PORT_LINUX
+#include "port/linux/linux_init.h"
+#endif
+
 #include <stdio.h>
 
 #define PRINTF(fmt,...)   printf((fmt), ##__VA_ARGS__)
@@ -31,25 +39,95 @@ extern "C" {
 #endif
 
 /**
-* @brief initialization of tm4c123
+* @brief initialization of platform
 * 
 * This function needs to have:
 * - init of system clock
-* - init of I2C - max speed 400kbs
+* - init of I2C in standard mode (100kbs), see platform_i2cSetSpeed()
 * - init of UART and others so printf function can be used
 *
 * @return 0 on sucess, 
 */
 int platform_init(void);
 
+/**
+* @brief free running timestamp counter, it keeps running while core sleeps
+*
+* Counter wraps at 2^32, only difference of two values is meaningful.
+* It runs from platform_init(), wraps after at least 100 s.
+*
+* @return value of counter, platform_timestampHz() counts per second
+*/
+uint32_t platform_timestamp(void);
+
+/**
+* @brief frequency of platform_timestamp() counter
+*
+* @return counts per second
+*/
+uint32_t platform_timestampHz(void);
+
+/**
+* @brief one-shot alarm, handler is called from interrupt when counter reaches timestamp
+*
+* There is one alarm, new call replaces the one which didn't fire yet. Handler
+* can set the next alarm. Timestamp which already passed fires at once, so it
+* must be at most half of counter range ahead.
+*
+* @param timestamp value of platform_timestamp() when handler is called
+* @param handler pointer to alarm handler function, NULL cancels the alarm
+* @return 0 on sucess, 
+*/
+int platform_scheduleAt(uint32_t timestamp, void (*handler)(void));
+
 /**
 * @brief init of 1 ms timer
 * 
-* @param interruptHandler pointer to timer handler function
+* Compatibility layer on platform_scheduleAt(), it takes the alarm. Every tick
+* wakes the core, so code which waits long should set its own alarm instead.
+*
+* @param interruptHandler pointer to timer handler function, NULL stops the timer
 * @return 0 on sucess, 
 */
 int platform_configure1msInterrupt(void (*interruptHandler)(void));
 
+/**
+* @brief called by code which busy-waits for time to pass or for an interrupt
+*
+* On hardware it returns at once. On simulated platform it moves virtual time
+* to the next event if nothing else happened since the last call.
+*/
+void platform_idle(void);
+
+/**
+* @brief sleep until an interrupt or other event
+*
+* Returns at once if event came since the previous return, so event which comes
+* between check of condition and the call is not lost. Alarm and 1 ms timer
+* wake the core, without them only DRDY and i2c interrupts do.
+* On hardware core sleeps with WFI, on Linux thread blocks until timer or DRDY
+* handler is called, on simulated platform virtual time moves to the next event.
+*/
+void platform_waitForEvent(void);
+
+/**
+* @brief free running high resolution counter, CPU cycles where platform has them
+*
+* Counter wraps around, only difference of two values close in time is meaningful.
+* Differences up to 4 s are valid on every platform.
+*
+* @return value of counter
+*/
+uint32_t platform_cycles(void);
+
+/**
+* @brief convert difference of two platform_cycles() values to nanoseconds
+*
+* @param cycles difference of counter values
+* @return time in nanoseconds
+*/
+uint64_t platform_cyclesToNs(uint32_t cycles);
+
 /**
 * @brief init of falling edge interrupt pin.
 *
@@ -58,6 +136,23 @@ int platform_configure1msInterrupt(void (*interruptHandler)(void));
 */
 int platform_configureInterruptPin(void (*interruptHandler)(void));
 
+/** @brief most DRDY pins, one for each device on TMP006 bus */
+#define PLATFORM_DRDY_MAX_PINS  8
+
+/**
+* @brief init of falling edge interrupts on DRDY pins of several devices
+*
+* Pins are on one port, pin i belongs to device at address 0x40 + i, see
+* tmp006_busDrdy(). Port interrupt reads status
+* of the pins once, clears it and calls handler with bitmap of devices whose
+* DRDY fell, so edges which come together are handled in one call.
+*
+* @param pinCount number of pins, from address 0x40 to the highest one, at most PLATFORM_DRDY_MAX_PINS
+* @param interruptHandler called with bit i set if DRDY of device at 0x40 + i fell, see tmp006_busDrdy()
+* @return 0 on sucess, 
+*/
+int platform_configureDrdyPins(uint8_t pinCount, void (*interruptHandler)(uint8_t readyMask));
+
 /**
 * @brief i2c write command
 * @param slaveAddr address of slave
@@ -68,6 +163,57 @@ int platform_configureInterruptPin(void (*interruptHandler)(void));
 */
 int platform_i2cRead(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length);
 
+/**
+* @brief i2c read command without register select phase
+*
+* Reads from the register device pointer currently points to.
+*
+* @param slaveAddr address of slave
+* @param data pointer to a data where received bytes will be stored
+* @param length length of data you want to receive
+* @return 0 on success or error code on failure.
+*/
+int platform_i2cReadCurrent(uint8_t slaveAddr, uint8_t *data, uint16_t length);
+
+/**
+* @brief start i2c transaction without waiting for it
+*
+* Transaction is performed in background, when it's finished tmp006_complete()
+* is called, possibly from interrupt context.
+*
+* @param txn pointer to transaction, must be valid until it's finished
+* @return 0 if transaction is started or error code on failure.
+*/
+int platform_i2cStart(TMP006_Transaction *txn);
+
+/**
+* @brief submit array of i2c transactions, they are performed back-to-back
+*
+* Transactions are executed in order without CPU involvement between them.
+* tmp006_complete() is called for each of them, done is called once when all are finished.
+* Failed transaction doesn't stop the rest, check status of each one.
+*
+* @param txns array of transactions, must be valid until done is called
+* @param count number of transactions
+* @param done function called when all transactions are finished
+* @param context user data for done
+* @return 0 if transactions are queued or error code on failure.
+*/
+int platform_i2cSubmit(TMP006_Transaction *txns, uint16_t count,
+                       void (*done)(TMP006_Transaction *txns, uint16_t count, void *context),
+                       void *context);
+
+/**
+* @brief change SCL rate of i2c bus
+*
+* Rate is rounded down to the closest one platform can generate.
+*
+* @param speedHz requested rate, TMP006_I2C_STANDARD_MODE or TMP006_I2C_FAST_MODE
+* @return achieved rate in Hz, 0 if requested rate isn't supported
+* @note must not be called while transaction is in progress
+*/
+uint32_t platform_i2cSetSpeed(uint32_t speedHz);
+
 /**
 * @brief i2c write command
 *
@@ -0,0 +1,106 @@
+/**
+* @file linux_i2c.c
+* @brief i2c backend based on i2c-dev
+*
+* @author Zarko Milojicic
+*/
+
+#include "linux_i2c.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+
+/**
+* @brief translate error of adapter driver into error codes of the driver
+*
+* Adapters report address NACK with ENXIO and data NACK with EREMOTEIO,
+* some of them use EREMOTEIO for both.
+*/
+static int translateError(int error)
+{
+    //ENXIO and ETIMEDOUT already match, EAGAIN of lost arbitration would read as result not ready
+    if (error == EAGAIN)
+    {
+        return -ECOMM;
+    }
+
+    return (error == EREMOTEIO) ? -EIO : -error;
+}
+
+/** @brief timeout used when transfer doesn't have one, in 10 ms units of I2C_TIMEOUT */
+#define I2C_DEV_DEFAULT_TIMEOUT     100
+
+/**
+* @brief opened adapter
+*/
+typedef struct
+{
+    int fd;             /**< file descriptor of adapter */
+    uint32_t timeout;   /**< value of I2C_TIMEOUT set on adapter */
+} Adapter;
+
+/**
+* @brief send messages with one I2C_RDWR ioctl
+*/
+static int transfer(void *context, struct i2c_msg *msgs, uint32_t count, uint32_t timeoutUs)
+{
+    Adapter *adapter = context;
+    struct i2c_rdwr_ioctl_data data = {
+        .msgs = msgs,
+        .nmsgs = count
+    };
+
+    if (count > I2C_RDWR_IOCTL_MAX_MSGS)
+    {
+        return -EINVAL;
+    }
+
+    //adapter counts timeout in 10 ms units, it's set only when it changes
+    const uint32_t timeout = (timeoutUs == 0) ? I2C_DEV_DEFAULT_TIMEOUT : ((timeoutUs + 9999) / 10000);
+    if (timeout != adapter->timeout)
+    {
+        if (ioctl(adapter->fd, I2C_TIMEOUT, timeout) < 0)
+        {
+            return -errno;
+        }
+        adapter->timeout = timeout;
+    }
+
+    if (ioctl(adapter->fd, I2C_RDWR, &data) < 0)
+    {
+        return translateError(errno);
+    }
+
+    return 0;
+}
+
+static Adapter adapter = { .fd = -1 };
+
+int initI2cDev(Linux_I2cBackend *backend, const char *path)
+{
+    if ((backend == NULL) || (path == NULL))
+    {
+        return -EINVAL;
+    }
+
+    if (adapter.fd >= 0)
+    {
+        close(adapter.fd);
+    }
+
+    adapter.fd = open(path, O_RDWR | O_CLOEXEC);
+    if (adapter.fd < 0)
+    {
+        return -errno;
+    }
+    adapter.timeout = 0;
+
+    //bus speed is set by device tree, it can't be changed from user space
+    backend->transfer = transfer;
+    backend->setSpeed = NULL;
+    backend->context = &adapter;
+
+    return 0;
+}
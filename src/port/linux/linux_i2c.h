@@ -0,0 +1,36 @@
+/**
+* @file linux_i2c.h
+* @brief i2c backend based on i2c-dev
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef LINUX_I2C_H
+#define  LINUX_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "linux_init.h"
+
+/**
+* @brief open i2c adapter and fill backend with its functions
+*
+* Every transaction is sent with one I2C_RDWR ioctl, so pointer write and
+* data read are a repeated-start message pair in one syscall.
+*
+* @param backend backend structure to fill
+* @param path path of adapter, e.g. "/dev/i2c-1"
+* @return 0 on success or error code
+*/
+int initI2cDev(Linux_I2cBackend *backend, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //LINUX_I2C_H
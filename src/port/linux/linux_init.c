@@ -0,0 +1,284 @@
+/**
+* @file linux_init.c
+* @brief init file for linux host
+*
+* @author Zarko Milojicic
+*/
+
+#include "linux_init.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <linux/gpio.h>
+
+/** @brief most lines of port backend, one bit of readyMask each */
+#define PORT_MAX_LINES  8
+
+/**
+* @brief state of thread which waits for events on file descriptor
+*/
+typedef struct
+{
+    int fd;                   /**< timerfd or line request */
+    void (*volatile handler)(void); /**< called for every event */
+    pthread_t thread;
+    bool started;             /**< thread is running */
+
+    void (*portHandler)(uint8_t readyMask); /**< called for events of several lines */
+    uint32_t lines[PORT_MAX_LINES];         /**< offset of line of each bit in readyMask */
+    uint8_t lineCount;                      /**< number of watched lines */
+} EventSource;
+
+static EventSource timerSource = { .fd = -1 };
+static EventSource lineSource = { .fd = -1 };
+static EventSource portSource = { .fd = -1 };
+
+/**
+* @brief call handler when alarm expires
+*/
+static void *timerThread(void *arg)
+{
+    EventSource *source = arg;
+    uint64_t expirations;
+
+    while (read(source->fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+    {
+        //alarm can be cancelled while it expires
+        void (*handler)(void) = source->handler;
+        if (handler != NULL)
+        {
+            handler();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+* @brief call handler once for every edge on the line
+*/
+static void *lineThread(void *arg)
+{
+    EventSource *source = arg;
+    struct gpio_v2_line_event event;
+
+    while (read(source->fd, &event, sizeof(event)) == sizeof(event))
+    {
+        source->handler();
+    }
+
+    return NULL;
+}
+
+/**
+* @brief call handler once for all edges read together
+*/
+static void *portThread(void *arg)
+{
+    EventSource *source = arg;
+    struct gpio_v2_line_event events[16];
+    ssize_t length;
+
+    while ((length = read(source->fd, events, sizeof(events))) >= (ssize_t)sizeof(events[0]))
+    {
+        uint8_t readyMask = 0;
+        for (size_t n = 0; n < ((size_t)length / sizeof(events[0])); n++)
+        {
+            for (uint8_t i = 0; i < source->lineCount; i++)
+            {
+                if (events[n].offset == source->lines[i])
+                {
+                    readyMask |= (uint8_t)(1 << i);
+                }
+            }
+        }
+
+        if (readyMask != 0)
+        {
+            source->portHandler(readyMask);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+* @brief start thread of event source
+*/
+static int startSource(EventSource *source, void *(*thread)(void *), void (*handler)(void))
+{
+    source->handler = handler;
+
+    int status = pthread_create(&source->thread, NULL, thread, source);
+    if (status != 0)
+    {
+        return -status;
+    }
+    source->started = true;
+
+    return pthread_detach(source->thread) == 0 ? 0 : -EINVAL;
+}
+
+/**
+* @brief set one-shot timerfd at absolute time of CLOCK_MONOTONIC
+*/
+static int setAlarm(void *context, uint64_t atNs, void (*handler)(void))
+{
+    EventSource *source = context;
+    //zero disarms timer, time in the past expires at once
+    const uint64_t at = (handler == NULL) ? 0 : ((atNs == 0) ? 1 : atNs);
+    struct itimerspec spec = {
+        .it_value = { .tv_sec = at / 1000000000u, .tv_nsec = at % 1000000000u }
+    };
+
+    source->handler = handler;
+    if (timerfd_settime(source->fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0)
+    {
+        return -errno;
+    }
+
+    //thread waits for all alarms, it's started with the first one
+    if (!source->started && (handler != NULL))
+    {
+        return startSource(source, timerThread, handler);
+    }
+
+    return 0;
+}
+
+int initTimerfd(Linux_TimerBackend *backend)
+{
+    if (backend == NULL)
+    {
+        return -EINVAL;
+    }
+
+    if (timerSource.fd < 0)
+    {
+        timerSource.fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (timerSource.fd < 0)
+        {
+            return -errno;
+        }
+    }
+
+    backend->alarm = setAlarm;
+    backend->idle = NULL;
+    backend->now = NULL;
+    backend->context = &timerSource;
+
+    return 0;
+}
+
+/**
+* @brief start waiting for edges on requested line
+*/
+static int watchLine(void *context, void (*handler)(void))
+{
+    if (handler == NULL)
+    {
+        return -EINVAL;
+    }
+
+    return startSource(context, lineThread, handler);
+}
+
+/**
+* @brief start waiting for edges on requested lines
+*/
+static int watchPort(void *context, uint8_t lineCount, void (*handler)(uint8_t readyMask))
+{
+    EventSource *source = context;
+
+    if ((handler == NULL) || (lineCount == 0) || (lineCount > source->lineCount))
+    {
+        return -EINVAL;
+    }
+
+    source->lineCount = lineCount;
+    source->portHandler = handler;
+
+    return startSource(source, portThread, NULL);
+}
+
+/**
+* @brief request lines as inputs with falling edge events
+* @return file descriptor of request or error code
+*/
+static int requestLines(const char *chip, const uint32_t *lines, uint8_t count)
+{
+    int chipFd = open(chip, O_RDWR | O_CLOEXEC);
+    if (chipFd < 0)
+    {
+        return -errno;
+    }
+
+    //DRDY is open drain output of the sensor, active low
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+    for (uint8_t i = 0; i < count; i++)
+    {
+        request.offsets[i] = lines[i];
+    }
+    request.num_lines = count;
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    strncpy(request.consumer, "tmp006 drdy", sizeof(request.consumer) - 1);
+
+    int status = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &request);
+    int error = errno;
+    close(chipFd);
+    if (status < 0)
+    {
+        return -error;
+    }
+
+    return request.fd;
+}
+
+int initGpioLine(Linux_GpioBackend *backend, const char *chip, uint32_t line)
+{
+    if ((backend == NULL) || (chip == NULL))
+    {
+        return -EINVAL;
+    }
+
+    int fd = requestLines(chip, &line, 1);
+    if (fd < 0)
+    {
+        return fd;
+    }
+
+    lineSource.fd = fd;
+    backend->watch = watchLine;
+    backend->watchPort = NULL;
+    backend->context = &lineSource;
+
+    return 0;
+}
+
+int initGpioLines(Linux_GpioBackend *backend, const char *chip, const uint32_t *lines, uint8_t count)
+{
+    if ((backend == NULL) || (chip == NULL) || (lines == NULL) || (count == 0) || (count > PORT_MAX_LINES))
+    {
+        return -EINVAL;
+    }
+
+    int fd = requestLines(chip, lines, count);
+    if (fd < 0)
+    {
+        return fd;
+    }
+
+    portSource.fd = fd;
+    memcpy(portSource.lines, lines, count * sizeof(lines[0]));
+    portSource.lineCount = count;
+    backend->watch = NULL;
+    backend->watchPort = watchPort;
+    backend->context = &portSource;
+
+    return 0;
+}
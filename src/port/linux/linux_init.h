@@ -0,0 +1,165 @@
+/**
+* @file linux_init.h
+* @brief init file for linux host
+*
+* Every peripheral is reached through a backend structure, so the driver can
+* run against real hardware (i2c-dev, timerfd, GPIO character device) or
+* against simulated one. Backend set with linux_setXxxBackend() before
+* platform_init() is used instead of the default one.
+*
+* Build with PORT_LINUX defined, e.g.
+* gcc -std=gnu99 -DPORT_LINUX -Isrc src/main.c src/test.c src/test_framework.c
+*     src/tmp006/tmp006*.c src/sim/tmp006_sim.c src/port/linux/linux_*.c
+*     src/port/linux/platform_linux.c -lpthread -lm
+* With LINUX_SIMULATOR defined too, default backends are a simulated test board
+* on virtual time, see initSimBoard().
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef LINUX_INIT_H
+#define  LINUX_INIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <linux/i2c.h>
+
+#ifndef LINUX_I2C_DEVICE
+/** @brief i2c adapter used by default backend */
+#define LINUX_I2C_DEVICE        "/dev/i2c-1"
+#endif
+
+#ifndef LINUX_GPIO_CHIP
+/** @brief GPIO chip DRDY pin is connected to */
+#define LINUX_GPIO_CHIP         "/dev/gpiochip0"
+#endif
+
+#ifndef LINUX_DRDY_LINE
+/** @brief offset of DRDY line on LINUX_GPIO_CHIP */
+#define LINUX_DRDY_LINE         17
+#endif
+
+#ifndef LINUX_DRDY_FIRST_LINE
+/** @brief offset of DRDY line of device at 0x40 on LINUX_GPIO_CHIP, device at 0x40 + i uses line i after it */
+#define LINUX_DRDY_FIRST_LINE   20
+#endif
+
+/**
+* @brief i2c backend
+*/
+typedef struct Linux_I2cBackend
+{
+    /**
+    * Perform messages as one combined transaction, with repeated start between them
+    * and stop after the last one. Same semantics as I2C_RDWR ioctl.
+    * timeoutUs is deadline of transfer, 0 for backend default.
+    * Returns 0 or -ENXIO on address NACK, -EIO on data NACK, -ECOMM if
+    * arbitration was lost, -ETIMEDOUT or other error code.
+    */
+    int (*transfer)(void *context, struct i2c_msg *msgs, uint32_t count, uint32_t timeoutUs);
+
+    /** Optional, set SCL rate, returns achieved rate or 0 if it can't be changed */
+    uint32_t (*setSpeed)(void *context, uint32_t speedHz);
+
+    void *context; /**< Passed to every function of backend */
+} Linux_I2cBackend;
+
+/**
+* @brief one-shot timer backend
+*/
+typedef struct Linux_TimerBackend
+{
+    /**
+    * Call handler once at atNs of now(), or of CLOCK_MONOTONIC if there is no now(),
+    * from another thread. Time in the past fires at once, new alarm replaces the
+    * previous one, NULL handler cancels it.
+    */
+    int (*alarm)(void *context, uint64_t atNs, void (*handler)(void));
+
+    /** Optional, called while CPU waits for an event, virtual timers move time forward */
+    void (*idle)(void *context);
+
+    /** Optional, time in nanoseconds read by platform_cycles() and platform_timestamp() */
+    uint64_t (*now)(void *context);
+
+    void *context; /**< Passed to every function of backend */
+} Linux_TimerBackend;
+
+/**
+* @brief DRDY pin backend
+*/
+typedef struct Linux_GpioBackend
+{
+    /** Call handler on every falling edge of the pin, from another thread */
+    int (*watch)(void *context, void (*handler)(void));
+
+    /**
+    * Optional, for backend with DRDY lines of several devices. Call handler with bit i
+    * set for every line i which fell, edges read together are passed in one call.
+    */
+    int (*watchPort)(void *context, uint8_t lineCount, void (*handler)(uint8_t readyMask));
+
+    void *context; /**< Passed to every function of backend */
+} Linux_GpioBackend;
+
+/**
+* @brief use another i2c backend
+* @param backend pointer to backend, must be valid while it's used, NULL for default one
+*/
+void linux_setI2cBackend(const Linux_I2cBackend *backend);
+
+/**
+* @brief get number of transfers done by i2c backend
+*
+* Each transfer of i2c-dev backend is one I2C_RDWR syscall.
+* platform_i2cSubmit() packs messages of many transactions into one transfer.
+*/
+uint32_t linux_i2cTransferCount(void);
+
+/**
+* @brief use another timer backend
+* @param backend pointer to backend, must be valid while it's used, NULL for default one
+*/
+void linux_setTimerBackend(const Linux_TimerBackend *backend);
+
+/**
+* @brief use another DRDY pin backend
+* @param backend pointer to backend, must be valid while it's used, NULL for default one
+*/
+void linux_setGpioBackend(const Linux_GpioBackend *backend);
+
+/**
+* @brief init of timer backend based on timerfd
+* @param backend backend structure to fill
+* @return 0 on success or error code
+*/
+int initTimerfd(Linux_TimerBackend *backend);
+
+/**
+* @brief init of DRDY pin backend based on GPIO character device
+* @param backend backend structure to fill
+* @param chip path of GPIO chip, e.g. "/dev/gpiochip0"
+* @param line offset of line on the chip
+* @return 0 on success or error code
+*/
+int initGpioLine(Linux_GpioBackend *backend, const char *chip, uint32_t line);
+
+/**
+* @brief init of DRDY pins backend with several lines of GPIO character device
+* @param backend backend structure to fill
+* @param chip path of GPIO chip, e.g. "/dev/gpiochip0"
+* @param lines offset of line of each device on the chip
+* @param count number of lines, at most PLATFORM_DRDY_MAX_PINS
+* @return 0 on success or error code
+*/
+int initGpioLines(Linux_GpioBackend *backend, const char *chip, const uint32_t *lines, uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //LINUX_INIT_H
@@ -0,0 +1,284 @@
+/**
+* @file linux_sim.c
+* @brief backends which connect platform to simulated TMP006 devices
+*
+* @author Zarko Milojicic
+*/
+
+#include "linux_sim.h"
+#include <errno.h>
+#include <stddef.h>
+
+/** @brief the longest step of virtual time while CPU is idle */
+#define SIM_IDLE_MAX_US     1000000
+
+/**
+* @brief perform messages on simulated bus, stop after the last one or failed one
+*
+* Deadline is checked after every message.
+*/
+static int simTransfer(void *context, struct i2c_msg *msgs, uint32_t count, uint32_t timeoutUs)
+{
+    TMP006_SimBus *bus = context;
+    const uint64_t start = bus->now;
+    int status = 0;
+
+    for (uint32_t i = 0; (i < count) && (status == 0); i++)
+    {
+        if (msgs[i].flags & I2C_M_RD)
+        {
+            status = tmp006_simRead(bus, (uint8_t)msgs[i].addr, msgs[i].buf, msgs[i].len);
+        }
+        else
+        {
+            status = tmp006_simWrite(bus, (uint8_t)msgs[i].addr, msgs[i].buf, msgs[i].len);
+        }
+
+        if ((status == 0) && (timeoutUs != 0) && ((bus->now - start) > timeoutUs))
+        {
+            status = -ETIMEDOUT;
+        }
+    }
+    tmp006_simStop(bus);
+
+    return status;
+}
+
+/**
+* @brief change speed of simulated bus
+*/
+static uint32_t simSetSpeed(void *context, uint32_t speedHz)
+{
+    return tmp006_simSetSpeed(context, speedHz);
+}
+
+int initSimI2c(Linux_I2cBackend *backend, TMP006_SimBus *bus)
+{
+    if ((backend == NULL) || (bus == NULL))
+    {
+        return -EINVAL;
+    }
+
+    backend->transfer = simTransfer;
+    backend->setSpeed = simSetSpeed;
+    backend->context = bus;
+
+    return 0;
+}
+
+/** @brief handler of DRDY pin, there is one DRDY line */
+static void (*drdyCallback)(void);
+
+/**
+* @brief falling edge of DRDY pin of simulated device
+*/
+static void drdyEdge(TMP006_Sim *sim, void *context)
+{
+    if (drdyCallback != NULL)
+    {
+        drdyCallback();
+    }
+}
+
+/**
+* @brief connect handler to DRDY pin of simulated device
+*/
+static int simWatch(void *context, void (*handler)(void))
+{
+    TMP006_Sim *sim = context;
+
+    if (handler == NULL)
+    {
+        return -EINVAL;
+    }
+
+    drdyCallback = handler;
+    sim->drdyHandler = drdyEdge;
+
+    return 0;
+}
+
+int initSimGpio(Linux_GpioBackend *backend, TMP006_Sim *sim)
+{
+    if ((backend == NULL) || (sim == NULL))
+    {
+        return -EINVAL;
+    }
+
+    backend->watch = simWatch;
+    backend->watchPort = NULL;
+    backend->context = sim;
+
+    return 0;
+}
+
+/** @brief handler of port interrupt and its watched pins */
+static void (*portCallback)(uint8_t readyMask);
+static uint8_t portMask;
+
+/**
+* @brief interrupt of simulated port, status is read once and cleared
+*/
+static void portInterrupt(TMP006_SimPort *port, void *context)
+{
+    const uint8_t status = port->status;
+    port->status = 0;
+
+    if ((status & portMask) != 0)
+    {
+        portCallback(status & portMask);
+    }
+}
+
+/**
+* @brief connect handler to interrupt of simulated port
+*/
+static int simWatchPort(void *context, uint8_t lineCount, void (*handler)(uint8_t readyMask))
+{
+    TMP006_SimPort *port = context;
+
+    if ((handler == NULL) || (lineCount == 0) || (lineCount > port->pinCount))
+    {
+        return -EINVAL;
+    }
+
+    portCallback = handler;
+    portMask = (uint8_t)((1u << lineCount) - 1);
+    port->handler = portInterrupt;
+
+    return 0;
+}
+
+int initSimGpioPort(Linux_GpioBackend *backend, TMP006_SimPort *port)
+{
+    if ((backend == NULL) || (port == NULL))
+    {
+        return -EINVAL;
+    }
+
+    backend->watch = NULL;
+    backend->watchPort = simWatchPort;
+    backend->context = port;
+
+    return 0;
+}
+
+/** @brief handler of timer, there is one timer */
+static void (*tickCallback)(void);
+
+/** @brief virtual time seen by the last idle call */
+static uint64_t idleNow = TMP006_SIM_NEVER;
+
+/**
+* @brief tick of virtual timer
+*/
+static void simTick(void *context)
+{
+    tickCallback();
+}
+
+/**
+* @brief set alarm on virtual time of simulated bus, in whole microseconds
+*/
+static int simAlarm(void *context, uint64_t atNs, void (*handler)(void))
+{
+    tickCallback = handler;
+    tmp006_simSetAlarm(context, (atNs + 999) / 1000, (handler == NULL) ? NULL : simTick, NULL);
+
+    return 0;
+}
+
+/**
+* @brief move virtual time to the next event if CPU only waits
+*/
+static void simIdle(void *context)
+{
+    TMP006_SimBus *bus = context;
+
+    //loop which talks to devices moves time by itself
+    if (bus->now == idleNow)
+    {
+        tmp006_simIdle(bus, SIM_IDLE_MAX_US);
+    }
+    idleNow = bus->now;
+}
+
+/**
+* @brief virtual time with bus time which isn't added to it yet
+*/
+static uint64_t simNow(void *context)
+{
+    TMP006_SimBus *bus = context;
+
+    return (bus->now * 1000) + bus->busyNs;
+}
+
+int initSimTimer(Linux_TimerBackend *backend, TMP006_SimBus *bus)
+{
+    if ((backend == NULL) || (bus == NULL))
+    {
+        return -EINVAL;
+    }
+
+    backend->alarm = simAlarm;
+    backend->idle = simIdle;
+    backend->now = simNow;
+    backend->context = bus;
+
+    return 0;
+}
+
+/** @brief bus of simulated test board and places for sensors on it, the first one is fitted */
+static TMP006_SimBus bus;
+static TMP006_Sim sensors[TMP006_SIM_MAX_DEVICES];
+
+int initSimBoard(Linux_I2cBackend *i2c, Linux_TimerBackend *timer, Linux_GpioBackend *gpio)
+{
+    //one sensor with ADR0 and ADR1 low, like on test board
+    tmp006_simBusInit(&bus);
+    tmp006_simInit(&sensors[0], 0x40);
+    int status = tmp006_simAttach(&bus, &sensors[0]);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    status = initSimI2c(i2c, &bus);
+    if (status == 0)
+    {
+        status = initSimTimer(timer, &bus);
+    }
+    if (status == 0)
+    {
+        status = initSimGpio(gpio, &sensors[0]);
+    }
+
+    return status;
+}
+
+TMP006_Sim *simBoardSensor(void)
+{
+    return &sensors[0];
+}
+
+int simBoardPopulate(uint8_t count)
+{
+    if ((count == 0) || (count > TMP006_SIM_MAX_DEVICES))
+    {
+        return -EINVAL;
+    }
+
+    //sensors after the first one are attached last, so they are removed by shortening the list
+    bus.deviceCount = 1;
+    for (uint8_t i = 1; i < count; i++)
+    {
+        tmp006_simInit(&sensors[i], (uint8_t)(0x40 + i));
+        int status = tmp006_simAttach(&bus, &sensors[i]);
+        if (status != 0)
+        {
+            return status;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+* @file linux_sim.h
+* @brief backends which connect platform to simulated TMP006 devices
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef LINUX_SIM_H
+#define  LINUX_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "linux_init.h"
+#include "../../sim/tmp006_sim.h"
+
+/**
+* @brief fill i2c backend which performs transfers on simulated bus
+*
+* Every transfer takes virtual time of its SCL bits at the bus speed.
+*
+* @param backend backend structure to fill
+* @param bus simulated bus, must be valid while backend is used
+* @return 0 on success or error code
+*/
+int initSimI2c(Linux_I2cBackend *backend, TMP006_SimBus *bus);
+
+/**
+* @brief fill DRDY pin backend connected to DRDY pin of simulated device
+*
+* Handler is called on falling edge, from the code which advances virtual time.
+*
+* @param backend backend structure to fill
+* @param sim simulated device, must be valid while backend is used
+* @return 0 on success or error code
+*/
+int initSimGpio(Linux_GpioBackend *backend, TMP006_Sim *sim);
+
+/**
+* @brief fill DRDY pins backend connected to simulated port
+*
+* Handler is called once for edges which came at the same virtual time, with
+* bit i set for device on pin i of the port.
+*
+* @param backend backend structure to fill
+* @param port simulated port with connected devices, must be valid while backend is used
+* @return 0 on success or error code
+*/
+int initSimGpioPort(Linux_GpioBackend *backend, TMP006_SimPort *port);
+
+/**
+* @brief fill timer backend which runs on virtual time of simulated bus
+*
+* Alarm handler is called from the code which advances virtual time. Its idle
+* function moves time to the next alarm or to just before the next conversion
+* when nothing happened on the bus since the previous call, so waiting takes no time. platform_cycles() reads
+* virtual time too, so timestamps and latencies are in simulated nanoseconds.
+*
+* @param backend backend structure to fill
+* @param bus simulated bus, must be valid while backend is used
+* @return 0 on success or error code
+*/
+int initSimTimer(Linux_TimerBackend *backend, TMP006_SimBus *bus);
+
+/**
+* @brief fill all backends with simulated test board, one sensor on address 0x40
+*
+* @param i2c i2c backend structure to fill
+* @param timer timer backend structure to fill
+* @param gpio DRDY pin backend structure to fill
+* @return 0 on success or error code
+*/
+int initSimBoard(Linux_I2cBackend *i2c, Linux_TimerBackend *timer, Linux_GpioBackend *gpio);
+
+/**
+* @brief sensor of simulated test board, tests can change it to simulate faults or drift
+*
+* @return sensor filled by initSimBoard()
+*/
+TMP006_Sim *simBoardSensor(void);
+
+/**
+* @brief fit sensors on addresses 0x40 to 0x40 + count - 1 of simulated test board, the others are removed
+*
+* The first sensor is kept as it is, the others start in their power on state.
+*
+* @param count number of sensors, 1 - TMP006_SIM_MAX_DEVICES, 1 restores the test board
+* @return 0 on success or error code
+*/
+int simBoardPopulate(uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //LINUX_SIM_H
@@ -0,0 +1,518 @@
+/**
+* @file platform_linux.c
+* @brief init of platform
+*
+* @author Zarko Milojicic
+*/
+
+#include "linux_init.h"
+#include "linux_i2c.h"
+#include "linux_sim.h"
+#include "platform.h"
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <linux/i2c-dev.h>
+
+static Linux_I2cBackend defaultI2c;
+static Linux_TimerBackend defaultTimer;
+static Linux_GpioBackend defaultGpio;
+static Linux_GpioBackend defaultPortGpio;
+
+static const Linux_I2cBackend *i2c;
+static const Linux_TimerBackend *timer;
+static const Linux_GpioBackend *gpio;
+
+/** @brief number of transfers done by i2c backend */
+static volatile uint32_t transferCount;
+
+/** @brief handlers of alarm and DRDY pin, backends call them through wrappers which signal event */
+static void (*alarmCallback)(void);
+static void (*pinCallback)(void);
+static void (*drdyPortCallback)(uint8_t readyMask);
+
+/** @brief handler of 1 ms timer and timestamp of its next tick */
+static void (*timerCallback)(void);
+static uint32_t nextTick;
+
+/** @brief number of events, and the one platform_waitForEvent() returned on */
+static pthread_mutex_t eventLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t eventCond = PTHREAD_COND_INITIALIZER;
+static uint32_t eventCount;
+static uint32_t eventSeen;
+
+/** @brief time of timer backend when alarmCallback is due, guarded by eventLock with it */
+static uint64_t alarmAtNs;
+
+/** @brief most messages in one transfer, lowered if adapter refuses it */
+static uint32_t batchLimit = I2C_RDWR_IOCTL_MAX_MSGS;
+
+/** @brief messages of submitted transactions, and register address with data of writes */
+static struct i2c_msg batchMsgs[I2C_RDWR_IOCTL_MAX_MSGS];
+static uint8_t batchWrites[I2C_RDWR_IOCTL_MAX_MSGS][3];
+
+/**
+* @brief perform messages with i2c backend
+*/
+static int transfer(struct i2c_msg *msgs, uint32_t count, uint32_t timeoutUs)
+{
+    transferCount++;
+    
+    return i2c->transfer(i2c->context, msgs, count, timeoutUs);
+}
+
+/**
+* @brief wake thread waiting in platform_waitForEvent()
+*/
+static void signalEvent(void)
+{
+    pthread_mutex_lock(&eventLock);
+    eventCount++;
+    pthread_cond_broadcast(&eventCond);
+    pthread_mutex_unlock(&eventLock);
+}
+
+/**
+* @brief time of timer backend in nanoseconds
+*/
+static uint64_t timerNow(void)
+{
+    if (timer->now != NULL)
+    {
+        return timer->now(timer->context);
+    }
+
+    //timerfd alarms run on this clock
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+/**
+* @brief alarm handler given to backend
+*/
+static void alarmEvent(void)
+{
+    //alarm is one-shot, handler can set the next one. Expiry of alarm which was
+    //replaced meanwhile comes before the new one is due and leaves it armed.
+    void (*callback)(void) = NULL;
+    pthread_mutex_lock(&eventLock);
+    if ((alarmCallback != NULL) && (timerNow() >= alarmAtNs))
+    {
+        callback = alarmCallback;
+        alarmCallback = NULL;
+    }
+    pthread_mutex_unlock(&eventLock);
+    if (callback != NULL)
+    {
+        callback();
+    }
+    signalEvent();
+}
+
+/**
+* @brief millisecond tick, next one is counted from this one so ticks don't drift
+*/
+static void timerEvent(void)
+{
+    nextTick += 1000;
+    platform_scheduleAt(nextTick, timerEvent);
+
+    timerCallback();
+}
+
+/**
+* @brief DRDY handler given to backend
+*/
+static void pinEvent(void)
+{
+    pinCallback();
+    signalEvent();
+}
+
+/**
+* @brief DRDY port handler given to backend
+*/
+static void drdyPortEvent(uint8_t readyMask)
+{
+    drdyPortCallback(readyMask);
+    signalEvent();
+}
+
+/**
+* @brief number of messages transaction needs
+*/
+static uint32_t messageCount(const TMP006_Transaction *txn)
+{
+    return (txn->type == TMP006_TXN_READ) ? 2 : 1;
+}
+
+/**
+* @brief fill messages of transaction
+* @param txn transaction
+* @param msgs array of messageCount(txn) messages
+* @param writeBuffer 3 bytes for register address and data if transaction is write
+*/
+static void buildMessages(TMP006_Transaction *txn, struct i2c_msg *msgs, uint8_t *writeBuffer)
+{
+    switch (txn->type)
+    {
+        case TMP006_TXN_READ:
+            msgs[0] = (struct i2c_msg){ .addr = txn->addr, .flags = 0, .len = 1, .buf = &txn->reg };
+            msgs[1] = (struct i2c_msg){ .addr = txn->addr, .flags = I2C_M_RD, .len = 2, .buf = txn->data };
+            break;
+        case TMP006_TXN_READ_CURRENT:
+            msgs[0] = (struct i2c_msg){ .addr = txn->addr, .flags = I2C_M_RD, .len = 2, .buf = txn->data };
+            break;
+        default:
+            writeBuffer[0] = txn->reg;
+            writeBuffer[1] = txn->data[0];
+            writeBuffer[2] = txn->data[1];
+            msgs[0] = (struct i2c_msg){ .addr = txn->addr, .flags = 0, .len = 3, .buf = writeBuffer };
+            break;
+    }
+}
+
+void linux_setI2cBackend(const Linux_I2cBackend *backend)
+{
+    //default backend which is already open is used again
+    i2c = ((backend == NULL) && (defaultI2c.transfer != NULL)) ? &defaultI2c : backend;
+    batchLimit = I2C_RDWR_IOCTL_MAX_MSGS;
+}
+
+uint32_t linux_i2cTransferCount(void)
+{
+    return transferCount;
+}
+
+void linux_setTimerBackend(const Linux_TimerBackend *backend)
+{
+    timer = backend;
+}
+
+void linux_setGpioBackend(const Linux_GpioBackend *backend)
+{
+    //default backend which is already open is used again
+    gpio = ((backend == NULL) && (defaultGpio.watch != NULL)) ? &defaultGpio : backend;
+}
+
+int platform_init(void)
+{
+#ifdef LINUX_SIMULATOR
+    //test board on virtual time instead of hardware
+    if ((i2c == NULL) && (timer == NULL) && (gpio == NULL))
+    {
+        int status = initSimBoard(&defaultI2c, &defaultTimer, &defaultGpio);
+        if (status != 0)
+        {
+            return status;
+        }
+        i2c = &defaultI2c;
+        timer = &defaultTimer;
+        gpio = &defaultGpio;
+    }
+#endif
+
+    //default backends are opened only for peripherals which don't have one
+    if (i2c == NULL)
+    {
+        int status = initI2cDev(&defaultI2c, LINUX_I2C_DEVICE);
+        if (status != 0)
+        {
+            return status;
+        }
+        i2c = &defaultI2c;
+    }
+
+    if (timer == NULL)
+    {
+        int status = initTimerfd(&defaultTimer);
+        if (status != 0)
+        {
+            return status;
+        }
+        timer = &defaultTimer;
+    }
+
+    return 0;
+}
+
+uint32_t platform_timestamp(void)
+{
+    //microseconds, wraps after 71 minutes
+    return (uint32_t)(timerNow() / 1000);
+}
+
+uint32_t platform_timestampHz(void)
+{
+    return 1000000;
+}
+
+int platform_scheduleAt(uint32_t timestamp, void (*handler)(void))
+{
+    if (timer == NULL)
+    {
+        return -ENODEV;
+    }
+
+    if (handler == NULL)
+    {
+        pthread_mutex_lock(&eventLock);
+        alarmCallback = NULL;
+        pthread_mutex_unlock(&eventLock);
+        return timer->alarm(timer->context, 0, NULL);
+    }
+
+    //timestamp is extended to 64-bit time of backend, passed one fires at once
+    const uint64_t nowUs = timerNow() / 1000;
+    const int32_t delayUs = (int32_t)(timestamp - (uint32_t)nowUs);
+    const uint64_t atNs = (nowUs + ((delayUs > 0) ? delayUs : 0)) * 1000;
+
+    pthread_mutex_lock(&eventLock);
+    alarmCallback = handler;
+    alarmAtNs = atNs;
+    pthread_mutex_unlock(&eventLock);
+
+    return timer->alarm(timer->context, atNs, alarmEvent);
+}
+
+int platform_configure1msInterrupt(void (*interruptHandler)(void))
+{
+    if (timer == NULL)
+    {
+        return -ENODEV;
+    }
+
+    timerCallback = interruptHandler;
+    if (interruptHandler == NULL)
+    {
+        return platform_scheduleAt(0, NULL);
+    }
+
+    nextTick = platform_timestamp() + 1000;
+
+    return platform_scheduleAt(nextTick, timerEvent);
+}
+
+int platform_configureInterruptPin(void (*interruptHandler)(void))
+{
+    //DRDY line is optional, it's opened only when it's needed
+    if (gpio == NULL)
+    {
+        int status = initGpioLine(&defaultGpio, LINUX_GPIO_CHIP, LINUX_DRDY_LINE);
+        if (status != 0)
+        {
+            return status;
+        }
+        gpio = &defaultGpio;
+    }
+
+    if (interruptHandler == NULL)
+    {
+        return -EINVAL;
+    }
+
+    if (gpio->watch == NULL)
+    {
+        return -ENODEV;
+    }
+
+    pinCallback = interruptHandler;
+
+    return gpio->watch(gpio->context, pinEvent);
+}
+
+int platform_configureDrdyPins(uint8_t pinCount, void (*interruptHandler)(uint8_t readyMask))
+{
+    const Linux_GpioBackend *port = gpio;
+
+    if ((pinCount == 0) || (pinCount > PLATFORM_DRDY_MAX_PINS) || (interruptHandler == NULL))
+    {
+        return -EINVAL;
+    }
+
+    //backend which has only one DRDY line keeps it, consecutive lines are opened
+    if ((port == NULL) || (port->watchPort == NULL))
+    {
+        uint32_t lines[PLATFORM_DRDY_MAX_PINS];
+        for (uint8_t i = 0; i < pinCount; i++)
+        {
+            lines[i] = LINUX_DRDY_FIRST_LINE + i;
+        }
+
+        int status = initGpioLines(&defaultPortGpio, LINUX_GPIO_CHIP, lines, pinCount);
+        if (status != 0)
+        {
+            return status;
+        }
+        port = &defaultPortGpio;
+    }
+
+    drdyPortCallback = interruptHandler;
+
+    return port->watchPort(port->context, pinCount, drdyPortEvent);
+}
+
+int platform_i2cRead(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    //pointer write and data read with repeated start between them
+    struct i2c_msg msgs[2] = {
+        { .addr = slaveAddr, .flags = 0, .len = 1, .buf = &reg },
+        { .addr = slaveAddr, .flags = I2C_M_RD, .len = length, .buf = data }
+    };
+
+    return transfer(msgs, 2, 0);
+}
+
+int platform_i2cReadCurrent(uint8_t slaveAddr, uint8_t *data, uint16_t length)
+{
+    struct i2c_msg msg = { .addr = slaveAddr, .flags = I2C_M_RD, .len = length, .buf = data };
+
+    return transfer(&msg, 1, 0);
+}
+
+int platform_i2cStart(TMP006_Transaction *txn)
+{
+    struct i2c_msg msgs[2];
+    uint8_t writeBuffer[3];
+    
+    if (txn->type > TMP006_TXN_READ_CURRENT)
+    {
+        return -EINVAL;
+    }
+    
+    //there is no background engine, transaction is finished before return
+    buildMessages(txn, msgs, writeBuffer);
+    tmp006_complete(txn, transfer(msgs, messageCount(txn), txn->timeoutUs));
+    
+    return 0;
+}
+
+int platform_i2cSubmit(TMP006_Transaction *txns, uint16_t count,
+                       void (*done)(TMP006_Transaction *txns, uint16_t count, void *context),
+                       void *context)
+{
+    uint16_t first = 0;
+    
+    while (first < count)
+    {
+        //as many whole transactions as fit into one transfer
+        uint32_t msgCount = 0;
+        uint32_t timeoutUs = 0;
+        bool defaultTimeout = false;
+        uint16_t last = first;
+        while ((last < count) && ((msgCount + messageCount(&txns[last])) <= batchLimit))
+        {
+            buildMessages(&txns[last], &batchMsgs[msgCount], batchWrites[msgCount]);
+            msgCount += messageCount(&txns[last]);
+            //deadline of batch is sum of deadlines, unless one of them uses the default
+            timeoutUs += txns[last].timeoutUs;
+            defaultTimeout |= (txns[last].timeoutUs == 0);
+            last++;
+        }
+        
+        int status = transfer(batchMsgs, msgCount, defaultTimeout ? 0 : timeoutUs);
+        if ((status == -EOPNOTSUPP) && (batchLimit > 2))
+        {
+            //adapter limits number of messages, try again with smaller batch
+            batchLimit /= 2;
+            continue;
+        }
+        
+        for (uint16_t i = first; i < last; i++)
+        {
+            if ((status == 0) || ((last - first) == 1))
+            {
+                tmp006_complete(&txns[i], status);
+            }
+            else
+            {
+                //failed message isn't known, every transaction gets its own status
+                platform_i2cStart(&txns[i]);
+            }
+        }
+        
+        first = last;
+    }
+    
+    if (done != NULL)
+    {
+        done(txns, count, context);
+    }
+    
+    return 0;
+}
+
+void platform_idle(void)
+{
+    if ((timer != NULL) && (timer->idle != NULL))
+    {
+        timer->idle(timer->context);
+    }
+}
+
+void platform_waitForEvent(void)
+{
+    //simulated timer moves virtual time to the next event instead
+    if ((timer != NULL) && (timer->idle != NULL))
+    {
+        timer->idle(timer->context);
+        return;
+    }
+    
+    pthread_mutex_lock(&eventLock);
+    while (eventCount == eventSeen)
+    {
+        pthread_cond_wait(&eventCond, &eventLock);
+    }
+    eventSeen = eventCount;
+    pthread_mutex_unlock(&eventLock);
+}
+
+uint32_t platform_cycles(void)
+{
+    if ((timer != NULL) && (timer->now != NULL))
+    {
+        return (uint32_t)timer->now(timer->context);
+    }
+
+    //raw clock isn't slewed by NTP, one tick is one nanosecond
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec);
+}
+
+uint64_t platform_cyclesToNs(uint32_t cycles)
+{
+    return cycles;
+}
+
+uint32_t platform_i2cSetSpeed(uint32_t speedHz)
+{
+    if (i2c->setSpeed == NULL)
+    {
+        return 0;
+    }
+
+    return i2c->setSpeed(i2c->context, speedHz);
+}
+
+int platform_i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    //register address and data go in one message
+    uint8_t buffer[1 + 16];
+    struct i2c_msg msg = { .addr = slaveAddr, .flags = 0, .len = 1 + length, .buf = buffer };
+
+    if (length > (sizeof(buffer) - 1))
+    {
+        return -EINVAL;
+    }
+
+    buffer[0] = reg;
+    memcpy(&buffer[1], data, length);
+
+    return transfer(&msg, 1, 0);
+}
@@ -0,0 +1,20 @@
+/**
+* @file cpu.h
+* @brief Host stand-in of TivaWare driverlib/cpu.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_CPU_H__
+#define  __DRIVERLIB_CPU_H__
+
+#include <stdint.h>
+
+uint32_t CPUcpsid(void);
+uint32_t CPUcpsie(void);
+void CPUwfi(void);
+
+#endif //__DRIVERLIB_CPU_H__
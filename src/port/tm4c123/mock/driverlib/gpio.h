@@ -0,0 +1,48 @@
+/**
+* @file gpio.h
+* @brief Host stand-in of TivaWare driverlib/gpio.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_GPIO_H__
+#define  __DRIVERLIB_GPIO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_PIN_0              0x00000001
+#define GPIO_PIN_1              0x00000002
+#define GPIO_PIN_2              0x00000004
+#define GPIO_PIN_3              0x00000008
+#define GPIO_PIN_4              0x00000010
+#define GPIO_PIN_5              0x00000020
+#define GPIO_PIN_6              0x00000040
+#define GPIO_PIN_7              0x00000080
+
+#define GPIO_FALLING_EDGE       0x00000000
+#define GPIO_STRENGTH_2MA       0x00000001
+#define GPIO_PIN_TYPE_STD_WPU   0x0000000A
+
+void GPIOPinConfigure(uint32_t ui32PinConfig);
+void GPIOUnlockPin(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOOutputOD(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength, uint32_t ui32PadType);
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val);
+void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void));
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType);
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags);
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags);
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags);
+uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked);
+
+#endif //__DRIVERLIB_GPIO_H__
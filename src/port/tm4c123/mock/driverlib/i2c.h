@@ -0,0 +1,47 @@
+/**
+* @file i2c.h
+* @brief Host stand-in of TivaWare driverlib/i2c.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_I2C_H__
+#define  __DRIVERLIB_I2C_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C_MASTER_CMD_SINGLE_SEND              0x00000007
+#define I2C_MASTER_CMD_SINGLE_RECEIVE           0x00000007
+#define I2C_MASTER_CMD_BURST_SEND_START         0x00000003
+#define I2C_MASTER_CMD_BURST_SEND_CONT          0x00000001
+#define I2C_MASTER_CMD_BURST_SEND_FINISH        0x00000005
+#define I2C_MASTER_CMD_BURST_SEND_STOP          0x00000004
+#define I2C_MASTER_CMD_BURST_SEND_ERROR_STOP    0x00000004
+#define I2C_MASTER_CMD_BURST_RECEIVE_START      0x0000000b
+#define I2C_MASTER_CMD_BURST_RECEIVE_CONT       0x00000009
+#define I2C_MASTER_CMD_BURST_RECEIVE_FINISH     0x00000005
+#define I2C_MASTER_CMD_BURST_RECEIVE_ERROR_STOP 0x00000004
+
+#define I2C_MASTER_ERR_NONE     0
+#define I2C_MASTER_ERR_ADDR_ACK 0x00000004
+#define I2C_MASTER_ERR_DATA_ACK 0x00000008
+#define I2C_MASTER_ERR_ARB_LOST 0x00000010
+#define I2C_MASTER_ERR_CLK_TOUT 0x00000080
+
+void I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast);
+void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive);
+void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data);
+uint32_t I2CMasterDataGet(uint32_t ui32Base);
+void I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd);
+bool I2CMasterBusy(uint32_t ui32Base);
+uint32_t I2CMasterErr(uint32_t ui32Base);
+void I2CMasterIntEnable(uint32_t ui32Base);
+void I2CMasterIntDisable(uint32_t ui32Base);
+void I2CMasterIntClear(uint32_t ui32Base);
+void I2CIntRegister(uint32_t ui32Base, void (*pfnHandler)(void));
+
+#endif //__DRIVERLIB_I2C_H__
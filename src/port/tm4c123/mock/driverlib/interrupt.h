@@ -0,0 +1,21 @@
+/**
+* @file interrupt.h
+* @brief Host stand-in of TivaWare driverlib/interrupt.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define  __DRIVERLIB_INTERRUPT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void IntPendSet(uint32_t ui32Interrupt);
+bool IntMasterEnable(void);
+bool IntMasterDisable(void);
+
+#endif //__DRIVERLIB_INTERRUPT_H__
@@ -0,0 +1,18 @@
+/**
+* @file pin_map.h
+* @brief Host stand-in of TivaWare driverlib/pin_map.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define  __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PA0_U0RX           0x00000001
+#define GPIO_PA1_U0TX           0x00000401
+#define GPIO_PA6_I2C1SCL        0x00001803
+#define GPIO_PA7_I2C1SDA        0x00001C03
+
+#endif //__DRIVERLIB_PIN_MAP_H__
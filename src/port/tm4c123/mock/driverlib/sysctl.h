@@ -0,0 +1,37 @@
+/**
+* @file sysctl.h
+* @brief Host stand-in of TivaWare driverlib/sysctl.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define  __DRIVERLIB_SYSCTL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_I2C1      0xf0002001
+#define SYSCTL_PERIPH_TIMER0    0xf0000400
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_UART0     0xf0001800
+
+#define SYSCTL_SYSDIV_5         0xC2000000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_OSC_MAIN         0x00000000
+#define SYSCTL_XTAL_16MHZ       0x00000540
+
+void SysCtlClockSet(uint32_t ui32Config);
+uint32_t SysCtlClockGet(void);
+void SysCtlDelay(uint32_t ui32Count);
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+void SysCtlPeripheralReset(uint32_t ui32Peripheral);
+
+#endif //__DRIVERLIB_SYSCTL_H__
@@ -0,0 +1,15 @@
+/**
+* @file uart.h
+* @brief Host stand-in of TivaWare driverlib/uart.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __DRIVERLIB_UART_H__
+#define  __DRIVERLIB_UART_H__
+
+//UART is used only through uartstdio
+
+#endif //__DRIVERLIB_UART_H__
@@ -0,0 +1,36 @@
+/**
+* @file hw_i2c.h
+* @brief Host stand-in of TivaWare inc/hw_i2c.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __HW_I2C_H__
+#define  __HW_I2C_H__
+
+#define I2C_O_MSA               0x00000000  // I2C Master Slave Address
+#define I2C_O_MCS               0x00000004  // I2C Master Control/Status
+#define I2C_O_MDR               0x00000008  // I2C Master Data
+#define I2C_O_MTPR              0x0000000C  // I2C Master Timer Period
+#define I2C_O_MIMR              0x00000010  // I2C Master Interrupt Mask
+#define I2C_O_MRIS              0x00000014  // I2C Master Raw Interrupt Status
+#define I2C_O_FIFOCTL           0x00000F04  // I2C FIFO Control
+
+#define I2C_MCS_RUN             0x00000001  // I2C Master Enable
+#define I2C_MCS_START           0x00000002  // Generate START
+#define I2C_MCS_STOP            0x00000004  // Generate STOP
+#define I2C_MCS_ACK             0x00000008  // Data Acknowledge Enable
+
+#define I2C_MCS_BUSY            0x00000001  // Controller Busy
+#define I2C_MCS_ERROR           0x00000002  // Error
+#define I2C_MCS_ADRACK          0x00000004  // Acknowledge Address
+#define I2C_MCS_DATACK          0x00000008  // Acknowledge Data
+#define I2C_MCS_ARBLST          0x00000010  // Arbitration Lost
+#define I2C_MCS_BUSBSY          0x00000040  // Bus Busy
+
+#define I2C_MIMR_IM             0x00000001  // Master Interrupt Mask
+#define I2C_MRIS_RIS            0x00000001  // Master Raw Interrupt Status
+
+#endif //__HW_I2C_H__
@@ -0,0 +1,19 @@
+/**
+* @file hw_ints.h
+* @brief Host stand-in of TivaWare inc/hw_ints.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __HW_INTS_H__
+#define  __HW_INTS_H__
+
+#define INT_GPIOA               16
+#define INT_GPIOB               17
+#define INT_TIMER0A             35
+#define INT_TIMER1A             37
+#define INT_I2C1                53
+
+#endif //__HW_INTS_H__
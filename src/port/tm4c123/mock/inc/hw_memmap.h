@@ -0,0 +1,21 @@
+/**
+* @file hw_memmap.h
+* @brief Host stand-in of TivaWare inc/hw_memmap.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __HW_MEMMAP_H__
+#define  __HW_MEMMAP_H__
+
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define UART0_BASE              0x4000C000
+#define I2C1_BASE               0x40021000
+#define GPIO_PORTF_BASE         0x40025000
+#define TIMER0_BASE             0x40030000
+#define TIMER1_BASE             0x40031000
+
+#endif //__HW_MEMMAP_H__
@@ -0,0 +1,16 @@
+/**
+* @file hw_timer.h
+* @brief Host stand-in of TivaWare inc/hw_timer.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __HW_TIMER_H__
+#define  __HW_TIMER_H__
+
+#define TIMER_O_TAMR            0x00000004  // GPTM Timer A Mode
+#define TIMER_TAMR_TAMIE        0x00000020  // GPTM Timer A Match Interrupt Enable
+
+#endif //__HW_TIMER_H__
@@ -0,0 +1,24 @@
+/**
+* @file hw_types.h
+* @brief Host stand-in of TivaWare inc/hw_types.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __HW_TYPES_H__
+#define  __HW_TYPES_H__
+
+#include <stdint.h>
+
+/** @brief register access goes to register file of the model */
+#define HWREG(x)                (*mockRegister((uint32_t)(x)))
+
+/**
+* @brief register of the model at address, it is created on first access with value 0
+*/
+volatile uint32_t *mockRegister(uint32_t address);
+
+#endif //__HW_TYPES_H__
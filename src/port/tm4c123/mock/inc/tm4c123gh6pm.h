@@ -0,0 +1,15 @@
+/**
+* @file tm4c123gh6pm.h
+* @brief Host stand-in of TivaWare inc/tm4c123gh6pm.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __TM4C123GH6PM_H__
+#define  __TM4C123GH6PM_H__
+
+//port uses registers only through HWREG() and driverlib
+
+#endif //__TM4C123GH6PM_H__
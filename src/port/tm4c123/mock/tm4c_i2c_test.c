@@ -0,0 +1,483 @@
+/**
+* @file tm4c_i2c_test.c
+* @brief Host test of the tm4c123 i2c interrupt engine on the driverlib register model
+*
+* tm4c_i2c.c and tm4c_init.c are built unchanged against headers in this
+* directory. Build and run on host from the repository root, e.g.
+* gcc -std=gnu99 -Isrc -Isrc/port/tm4c123/mock/inc src/port/tm4c123/mock/tm4c_mock.c
+*     src/port/tm4c123/mock/tm4c_i2c_test.c
+*     src/port/tm4c123/tm4c_i2c.c src/port/tm4c123/tm4c_init.c
+*     src/tmp006/tmp006.c src/tmp006/tmp006_bus.c -o tm4c_i2c_test
+* Exit status is the number of failed tests.
+*
+* @author Zarko Milojicic
+*/
+
+#include "tm4c_mock.h"
+#include "test.h"
+#include "tmp006/tmp006_bus.h"
+#include "port/tm4c123/tm4c_i2c.h"
+
+#include <errno.h>
+#include <string.h>
+
+/** @brief system clock cycles per microsecond of the model */
+#define CYCLES_PER_US       (MOCK_CLOCK_HZ / 1000000)
+
+/** @brief longest run of one test, every transaction is bounded by its deadline */
+#define RUN_LIMIT_US        100000
+
+static uint32_t failures;
+
+/** @brief device at 0x40, all transactions go through the interrupt engine */
+static TMP006_Device device;
+
+/** @brief calls of batchDone() */
+static uint32_t batchCalls;
+static uint16_t batchCount;
+
+void setUp(void)
+{
+    mockReset();
+    initSystemClock_40MHz();
+    initI2c();
+    initI2cInterrupt();
+
+    memset(&device, 0, sizeof(device));
+    device.i2cRead = i2cRead;
+    device.i2cWrite = i2cWrite;
+    device.i2cReadCurrent = i2cReadCurrent;
+    device.i2cStart = i2cStart;
+    tmp006_init(&device, TMP006_PIN_LOW, TMP006_PIN_LOW);
+
+    batchCalls = 0;
+    batchCount = 0;
+}
+
+/**
+* @brief run test and count it if it fails, passed to RUN_TEST
+*/
+static bool counted(bool (*test)(void))
+{
+    const bool success = test();
+
+    failures += success ? 0 : 1;
+
+    return success;
+}
+
+static void batchDone(TMP006_Transaction *txns, uint16_t count, void *context)
+{
+    batchCalls++;
+    batchCount = count;
+}
+
+/**
+* @brief read register of device through interrupt engine
+*/
+static int isrRead(uint8_t reg, uint16_t *value)
+{
+    TMP006_Transaction txn;
+
+    int status = tmp006_readAsync(&device, reg, &txn, NULL, NULL);
+    if (status != 0)
+    {
+        return status;
+    }
+    mockRun(RUN_LIMIT_US);
+    *value = tmp006_transactionValue(&txn);
+
+    return (txn.status == TMP006_TXN_PENDING) ? -EINPROGRESS : txn.status;
+}
+
+/**
+* @brief write register of device through interrupt engine
+*/
+static int isrWrite(uint8_t reg, uint16_t value)
+{
+    TMP006_Transaction txn;
+
+    int status = tmp006_writeAsync(&device, reg, value, &txn, NULL, NULL);
+    if (status != 0)
+    {
+        return status;
+    }
+    mockRun(RUN_LIMIT_US);
+
+    return (txn.status == TMP006_TXN_PENDING) ? -EINPROGRESS : txn.status;
+}
+
+/**
+* @brief read is three interrupts, read of the same register again only two
+*/
+static bool test_read(void)
+{
+    uint16_t value = 0;
+
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    TEST_ASSERT(mockStats()->i2cInterrupts == 3);
+
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    TEST_ASSERT(mockStats()->i2cInterrupts == 5);
+
+    TEST_ASSERT(isrRead(TMP006_DEVICE_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_DEVICE_ID_VALUE);
+
+    TEST_ASSERT(!mockStats()->busOwned);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+static bool test_write(void)
+{
+    const uint16_t config = TMP006_CONTINUOUS_CONVERSION | TMP006_CONVERSION_RATE_1_CONV_PER_SEC;
+
+    TEST_ASSERT(isrWrite(TMP006_CONFIG, config) == 0);
+    TEST_ASSERT(mockSlave(0x40)->regs[TMP006_CONFIG] == config);
+    TEST_ASSERT(mockSlave(0x40)->writes == 1);
+    TEST_ASSERT(mockStats()->i2cInterrupts == 3);
+
+    uint16_t value = 0;
+    TEST_ASSERT(isrRead(TMP006_CONFIG, &value) == 0);
+    TEST_ASSERT(value == config);
+
+    TEST_ASSERT(!mockStats()->busOwned);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief absent device fails with -ENXIO after the address, bus is released with stop
+*/
+static bool test_addressNack(void)
+{
+    uint16_t value = 0;
+
+    tmp006_init(&device, TMP006_PIN_HIGH, TMP006_PIN_LOW);
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_ADDR_NACK);
+    TEST_ASSERT(mockStats()->i2cInterrupts == 1);
+    TEST_ASSERT(!mockStats()->busOwned);
+
+    tmp006_init(&device, TMP006_PIN_LOW, TMP006_PIN_LOW);
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief NACK of the first data byte fails write with -EIO, register keeps its value
+*/
+static bool test_dataNack(void)
+{
+    mockI2cFault(MOCK_FAULT_DATA_NACK, 1, 0);
+    TEST_ASSERT(isrWrite(TMP006_CONFIG, TMP006_POWER_DOWN) == TMP006_ERR_DATA_NACK);
+    TEST_ASSERT(mockSlave(0x40)->writes == 0);
+    TEST_ASSERT(mockSlave(0x40)->regs[TMP006_CONFIG] == 0x7400);
+    TEST_ASSERT(!mockStats()->busOwned);
+
+    TEST_ASSERT(isrWrite(TMP006_CONFIG, TMP006_POWER_DOWN) == 0);
+    TEST_ASSERT(mockSlave(0x40)->regs[TMP006_CONFIG] == TMP006_POWER_DOWN);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief lost arbitration fails with -ECOMM in any step, master sends no stop
+*/
+static bool test_arbitrationLost(void)
+{
+    uint16_t value = 0;
+
+    //address phase, repeated start and data byte of read
+    for (uint32_t command = 0; command < 3; command++)
+    {
+        const uint32_t commands = mockStats()->commands;
+
+        device.pointerRegValid = false;
+        mockI2cFault(MOCK_FAULT_ARB_LOST, command, 0);
+        TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_ARB_LOST);
+        TEST_ASSERT(mockStats()->commands == (commands + command + 1));
+        TEST_ASSERT(!mockStats()->busOwned);
+    }
+
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief slave which holds SDA fails transaction at its deadline, bus is cleared
+*/
+static bool test_timeout(void)
+{
+    uint16_t value = 0;
+
+    device.timeoutUs = 500;
+    mockI2cFault(MOCK_FAULT_STUCK, 1, 3);
+
+    const uint64_t start = mockStats()->now;
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_TIMEOUT);
+    const uint64_t elapsedUs = (mockStats()->now - start) / CYCLES_PER_US;
+
+    //deadline plus nine clocks of recovery at most
+    TEST_ASSERT((elapsedUs >= 500) && (elapsedUs <= 600));
+    TEST_ASSERT(mockStats()->timerInterrupts == 1);
+    TEST_ASSERT(mockStats()->busClears == 1);
+    TEST_ASSERT(!mockStats()->busOwned);
+
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    TEST_ASSERT(mockStats()->timerInterrupts == 1);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief second transaction is rejected while the first one is on the bus
+*/
+static bool test_busy(void)
+{
+    TMP006_Transaction first;
+    TMP006_Transaction second;
+
+    TEST_ASSERT(tmp006_prepareRead(&device, TMP006_MANUFACTURER_ID, &first) == 0);
+    TEST_ASSERT(tmp006_prepareRead(&device, TMP006_DEVICE_ID, &second) == 0);
+    TEST_ASSERT(i2cStart(&first) == 0);
+    TEST_ASSERT(i2cStart(&second) == -EBUSY);
+    TEST_ASSERT(i2cSubmit(&second, 1, batchDone, NULL) == -EBUSY);
+
+    mockRun(RUN_LIMIT_US);
+    TEST_ASSERT(first.status == 0);
+    TEST_ASSERT(second.status == TMP006_TXN_PENDING);
+    TEST_ASSERT(batchCalls == 0);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief every error of queued transaction is reported for it, queue goes on
+*/
+static bool test_submitErrors(void)
+{
+    TMP006_Device absent = device;
+    TMP006_Transaction txns[5];
+
+    absent.i2cAddress = 0x41;
+    absent.timeoutUs = 1000;
+    TEST_ASSERT(tmp006_prepareRead(&device, TMP006_MANUFACTURER_ID, &txns[0]) == 0);
+    TEST_ASSERT(tmp006_prepareRead(&absent, TMP006_MANUFACTURER_ID, &txns[1]) == 0);
+    TEST_ASSERT(tmp006_prepareRead(&device, TMP006_DEVICE_ID, &txns[2]) == 0);
+    TEST_ASSERT(tmp006_prepareRead(&absent, TMP006_DEVICE_ID, &txns[3]) == 0);
+    TEST_ASSERT(tmp006_prepareRead(&device, TMP006_MANUFACTURER_ID, &txns[4]) == 0);
+    txns[3].addr = 0x40;
+
+    //commands: 3 of txns[0], start and error stop of txns[1], arbitration lost in start of txns[2]
+    mockI2cFault(MOCK_FAULT_ARB_LOST, 5, 0);
+    TEST_ASSERT(i2cSubmit(txns, 5, batchDone, NULL) == 0);
+    mockRun(RUN_LIMIT_US);
+    TEST_ASSERT(batchCalls == 1);
+    TEST_ASSERT(batchCount == 5);
+    TEST_ASSERT((txns[0].status == 0) && (tmp006_transactionValue(&txns[0]) == TMP006_MANUF_ID_VALUE));
+    TEST_ASSERT(txns[1].status == TMP006_ERR_ADDR_NACK);
+    TEST_ASSERT(txns[2].status == TMP006_ERR_ARB_LOST);
+    TEST_ASSERT((txns[3].status == 0) && (tmp006_transactionValue(&txns[3]) == TMP006_DEVICE_ID_VALUE));
+    TEST_ASSERT((txns[4].status == 0) && (tmp006_transactionValue(&txns[4]) == TMP006_MANUF_ID_VALUE));
+
+    //deadline of stuck transaction in the middle of queue
+    batchCalls = 0;
+    txns[1].addr = 0x40;
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        txns[i].status = TMP006_TXN_PENDING;
+    }
+    mockI2cFault(MOCK_FAULT_STUCK, 4, 2);
+    TEST_ASSERT(i2cSubmit(txns, 5, batchDone, NULL) == 0);
+    mockRun(RUN_LIMIT_US);
+    TEST_ASSERT(batchCalls == 1);
+    TEST_ASSERT(txns[0].status == 0);
+    TEST_ASSERT(txns[1].status == TMP006_ERR_TIMEOUT);
+    TEST_ASSERT(txns[2].status == 0);
+    TEST_ASSERT(txns[3].status == 0);
+    TEST_ASSERT(txns[4].status == 0);
+    TEST_ASSERT(mockStats()->busClears == 1);
+    TEST_ASSERT(!mockStats()->busOwned);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief sweep of bus with one absent sensor runs as one queue without gaps
+*/
+static bool test_sweepQueue(void)
+{
+    const enum TMP006_PinState a1[] = {TMP006_PIN_LOW, TMP006_PIN_HIGH, TMP006_PIN_SDA};
+    TMP006_Bus bus;
+    TMP006_Transaction txns[TMP006_BUS_SWEEP_LENGTH];
+    TMP006_Sample samples[TMP006_BUS_MAX_DEVICES];
+    uint16_t count = 0;
+    uint8_t readyMask = 0;
+
+    TEST_ASSERT(tmp006_busInit(&bus, &device) == 0);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, a1[i], 1, NULL) == 0);
+        MockSlave *slave = mockSlave(bus.devices[i].i2cAddress);
+        slave->present = (i != 1);
+        slave->regs[TMP006_VOBJECT] = (uint16_t)(0x0100 * (i + 1));
+    }
+    TEST_ASSERT(tmp006_busPrepareSweep(&bus, txns, &count) == 0);
+    TEST_ASSERT(count == 6);
+
+    const MockStats before = *mockStats();
+    TEST_ASSERT(i2cSubmit(txns, count, batchDone, NULL) == 0);
+
+    //nothing else gets the bus until the whole queue is done
+    TMP006_Transaction other;
+    TEST_ASSERT(tmp006_prepareRead(&device, TMP006_DEVICE_ID, &other) == 0);
+    TEST_ASSERT(i2cStart(&other) == -EBUSY);
+    TEST_ASSERT(i2cSubmit(&other, 1, batchDone, NULL) == -EBUSY);
+
+    mockRun(RUN_LIMIT_US);
+    TEST_ASSERT(batchCalls == 1);
+    TEST_ASSERT(batchCount == count);
+    TEST_ASSERT(other.status == TMP006_TXN_PENDING);
+    TEST_ASSERT((txns[0].status == 0) && (txns[1].status == 0));
+    TEST_ASSERT((txns[2].status == TMP006_ERR_ADDR_NACK) && (txns[3].status == TMP006_ERR_ADDR_NACK));
+    TEST_ASSERT((txns[4].status == 0) && (txns[5].status == 0));
+
+    //next transaction starts from interrupt of the previous one, bus is never idle
+    const MockStats *after = mockStats();
+    TEST_ASSERT((after->now - before.now) == (after->busCycles - before.busCycles));
+    TEST_ASSERT((after->i2cInterrupts - before.i2cInterrupts) == ((4 * 3) + 2));
+    TEST_ASSERT(after->timerInterrupts == before.timerInterrupts);
+
+    TEST_ASSERT(tmp006_busSweepResult(&bus, txns, samples, &readyMask) == TMP006_ERR_ADDR_NACK);
+    TEST_ASSERT(readyMask == 0x05);
+    TEST_ASSERT((samples[0].voltage == 0x0100) && (samples[2].voltage == 0x0300));
+    TEST_ASSERT((samples[0].temperature == (25 * 32)) && (samples[2].temperature == (25 * 32)));
+
+    TEST_ASSERT(!mockStats()->busOwned);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief interrupt engine works after blocking read recovered the bus
+*/
+static bool test_blockingTimeout(void)
+{
+    uint8_t data[2];
+    uint16_t value = 0;
+
+    mockI2cFault(MOCK_FAULT_STUCK, 1, 5);
+    TEST_ASSERT(i2cRead(0x40, TMP006_MANUFACTURER_ID, data, 2) == TMP006_ERR_TIMEOUT);
+    TEST_ASSERT(mockStats()->busClears == 1);
+    TEST_ASSERT(!mockStats()->busOwned);
+
+    TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    TEST_ASSERT(mockStats()->timerInterrupts == 0);
+    TEST_ASSERT(mockStats()->violations == 0);
+
+    return true;
+}
+
+/**
+* @brief system clock isn't read in interrupt of each transaction, blocking read or bus recovery
+*/
+static bool test_clockReads(void)
+{
+    const uint32_t clockReads = mockStats()->clockReads;
+    uint8_t data[2];
+    uint16_t value = 0;
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        device.pointerRegValid = false;
+        TEST_ASSERT(isrRead(TMP006_MANUFACTURER_ID, &value) == 0);
+    }
+    TEST_ASSERT(i2cRead(0x40, TMP006_MANUFACTURER_ID, data, 2) == 0);
+    mockI2cFault(MOCK_FAULT_STUCK, 1, 5);
+    TEST_ASSERT(i2cRead(0x40, TMP006_MANUFACTURER_ID, data, 2) == TMP006_ERR_TIMEOUT);
+    TEST_ASSERT(mockStats()->busClears == 1);
+    TEST_ASSERT(mockStats()->clockReads == clockReads);
+
+    return true;
+}
+
+/** @brief Timer0 alarms of event test */
+static uint32_t alarms;
+
+static void alarmTick(void)
+{
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+    timerCancelAlarm();
+    alarms++;
+}
+
+/**
+* @brief completion between the check of the caller and its sleep doesn't wait for the next interrupt
+*/
+static bool test_waitForEvent(void)
+{
+    TMP006_Transaction txn;
+
+    alarms = 0;
+    initTimestampTimer(alarmTick);
+    timerSetAlarm(timestampCounter() + (10000 * CYCLES_PER_US));
+    //completions of earlier tests were signalled too
+    while (alarms == 0)
+    {
+        waitForEvent();
+    }
+
+    //interrupts of the transaction run while main loop is busy
+    timerSetAlarm(timestampCounter() + (10000 * CYCLES_PER_US));
+    TEST_ASSERT(tmp006_readAsync(&device, TMP006_MANUFACTURER_ID, &txn, NULL, NULL) == 0);
+    while (txn.status == TMP006_TXN_PENDING)
+    {
+        CPUwfi();
+    }
+    TEST_ASSERT(txn.status == 0);
+
+    const uint64_t now = mockStats()->now;
+    waitForEvent();
+    TEST_ASSERT((mockStats()->now == now) && (alarms == 1));
+    waitForEvent();
+    TEST_ASSERT(alarms == 2);
+
+    return true;
+}
+
+int main(void)
+{
+    RUN_TEST("Read through i2c interrupt", counted, test_read);
+    RUN_TEST("Write through i2c interrupt", counted, test_write);
+    RUN_TEST("Address NACK", counted, test_addressNack);
+    RUN_TEST("Data NACK", counted, test_dataNack);
+    RUN_TEST("Arbitration lost", counted, test_arbitrationLost);
+    RUN_TEST("Deadline of stuck bus", counted, test_timeout);
+    RUN_TEST("Interrupt after blocking timeout", counted, test_blockingTimeout);
+    RUN_TEST("Busy i2c master", counted, test_busy);
+    RUN_TEST("Errors in submitted queue", counted, test_submitErrors);
+    RUN_TEST("Sweep of bus in one queue", counted, test_sweepQueue);
+    RUN_TEST("System clock read once", counted, test_clockReads);
+    RUN_TEST("Event before sleep", counted, test_waitForEvent);
+
+    PRINTF("%u test(s) failed\n", failures);
+
+    return (int)failures;
+}
@@ -0,0 +1,798 @@
+/**
+* @file tm4c_mock.c
+* @brief Register model of the TivaWare driverlib parts used by the tm4c123 port
+*
+* Master commands follow the bits of MCS register (RUN, START, STOP, ACK), so
+* the same command values as in driverlib give the same bus sequence. Every
+* byte takes 9 SCL periods of 20 * (MTPR + 1) cycles, start and stop one more.
+* Stop without RUN is modelled as instant.
+*
+* @author Zarko Milojicic
+*/
+
+#include "tm4c_mock.h"
+#include "inc/hw_types.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_i2c.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_timer.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/timer.h"
+#include "driverlib/i2c.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/cpu.h"
+#include "utils/uartstdio.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Most registers accessed through HWREG() */
+#define MOCK_REGISTERS      32
+
+/** @brief Most handler calls in one dispatch, more means handler doesn't clear its interrupt */
+#define MOCK_MAX_NESTED     1000
+
+/** @brief Register of I2C1 */
+#define I2C_REG(offset)     HWREG(I2C1_BASE + (offset))
+
+/**
+* @brief General purpose timer, only timer A is used
+*/
+typedef struct
+{
+    uint32_t config;        /**< TIMER_CFG_ONE_SHOT or TIMER_CFG_PERIODIC_UP */
+    uint32_t load;          /**< Start value of one-shot, period - 1 of periodic */
+    uint32_t match;         /**< Match value */
+    bool     enabled;
+    uint64_t start;         /**< Time of TimerEnable() */
+    uint32_t mask;          /**< Enabled interrupts */
+    uint32_t raw;           /**< Raw interrupt status */
+    bool     pended;        /**< Interrupt pended by IntPendSet() */
+    uint64_t matchAt;       /**< Time of next match, MOCK_NEVER if it isn't armed */
+    void   (*handler)(void);
+} Timer;
+
+static struct
+{
+    uint32_t address;
+    volatile uint32_t value;
+} registers[MOCK_REGISTERS];
+static uint8_t registerCount;
+
+static MockStats stats;
+static MockSlave slaves[8];
+static Timer timers[2];
+
+/**
+* @brief state of I2C1 master and its pins
+*/
+static struct
+{
+    bool       enabled;     /**< Master initialized by I2CMasterInitExpClk() */
+    bool       running;     /**< Command is on the bus */
+    uint64_t   doneAt;      /**< End of running command, MOCK_NEVER while SDA is held */
+    uint32_t   error;       /**< Error bits of the last command */
+    MockSlave *addressed;   /**< Slave which acknowledged its address */
+    void     (*handler)(void);
+
+    enum MockI2cFault fault;
+    uint32_t   faultAt;     /**< Number of commands before the fault */
+    uint8_t    holdClocks;  /**< SCL clocks until SDA is released */
+    bool       sdaHeld;     /**< Slave holds SDA low */
+
+    bool       pinsGpio;    /**< PA6 and PA7 are taken from I2C1 */
+    uint8_t    pins;        /**< Levels of PA6 and PA7 written in GPIO mode */
+} i2c;
+
+static bool inInterrupt;
+
+volatile uint32_t *mockRegister(uint32_t address)
+{
+    for (uint8_t i = 0; i < registerCount; i++)
+    {
+        if (registers[i].address == address)
+        {
+            return &registers[i].value;
+        }
+    }
+
+    if (registerCount == MOCK_REGISTERS)
+    {
+        fprintf(stderr, "tm4c mock: too many registers\n");
+        abort();
+    }
+    registers[registerCount].address = address;
+    registers[registerCount].value = 0;
+
+    return &registers[registerCount++].value;
+}
+
+/**
+* @brief registers of I2C1 after reset
+*/
+static void resetI2c(void)
+{
+    I2C_REG(I2C_O_MSA) = 0;
+    I2C_REG(I2C_O_MDR) = 0;
+    I2C_REG(I2C_O_MTPR) = 1;
+    I2C_REG(I2C_O_MIMR) = 0;
+    I2C_REG(I2C_O_MRIS) = 0;
+
+    i2c.enabled = false;
+    i2c.running = false;
+    i2c.error = 0;
+    i2c.addressed = NULL;
+    stats.busOwned = false;
+}
+
+void mockReset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    memset(timers, 0, sizeof(timers));
+    memset(&i2c, 0, sizeof(i2c));
+    registerCount = 0;
+    inInterrupt = false;
+    timers[0].matchAt = MOCK_NEVER;
+    timers[1].matchAt = MOCK_NEVER;
+    i2c.pins = GPIO_PIN_6 | GPIO_PIN_7;
+    resetI2c();
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        memset(&slaves[i], 0, sizeof(slaves[i]));
+        slaves[i].regs[0x00] = 0x0000;
+        slaves[i].regs[0x01] = 25 * 32 * 4;
+        slaves[i].regs[0x02] = 0x7400;
+        slaves[i].regs[0xFE] = 0x5449;
+        slaves[i].regs[0xFF] = 0x0067;
+    }
+    slaves[0].present = true;
+}
+
+MockSlave *mockSlave(uint8_t address)
+{
+    return ((address >= 0x40) && (address <= 0x47)) ? &slaves[address - 0x40] : NULL;
+}
+
+void mockI2cFault(enum MockI2cFault fault, uint32_t command, uint8_t holdClocks)
+{
+    i2c.fault = fault;
+    i2c.faultAt = command;
+    i2c.holdClocks = holdClocks;
+}
+
+const MockStats *mockStats(void)
+{
+    return &stats;
+}
+
+/**
+* @brief timer of base address
+*/
+static Timer *timerOf(uint32_t base)
+{
+    return (base == TIMER0_BASE) ? &timers[0] : &timers[1];
+}
+
+/**
+* @brief arm match of periodic timer at the next time its value equals match
+*/
+static void armMatch(Timer *timer)
+{
+    const bool armed = timer->enabled && (timer->config == TIMER_CFG_PERIODIC_UP) &&
+                       (timer->mask & TIMER_TIMA_MATCH) &&
+                       (HWREG((timer == &timers[0] ? TIMER0_BASE : TIMER1_BASE) + TIMER_O_TAMR) & TIMER_TAMR_TAMIE);
+    if (!armed)
+    {
+        timer->matchAt = MOCK_NEVER;
+        return;
+    }
+
+    const uint32_t value = (uint32_t)(stats.now - timer->start);
+    const uint32_t ahead = timer->match - value;
+    timer->matchAt = stats.now + ((ahead == 0) ? (UINT64_C(1) << 32) : ahead);
+}
+
+/**
+* @brief time of the next event of the model
+*/
+static uint64_t nextEvent(void)
+{
+    uint64_t next = i2c.running ? i2c.doneAt : MOCK_NEVER;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        const Timer *timer = &timers[i];
+        if (timer->enabled && (timer->config == TIMER_CFG_ONE_SHOT))
+        {
+            const uint64_t expiry = timer->start + timer->load;
+            next = (expiry < next) ? expiry : next;
+        }
+        next = (timer->matchAt < next) ? timer->matchAt : next;
+    }
+
+    return next;
+}
+
+/**
+* @brief set raw interrupt status of events due at current time
+*/
+static void processEvents(void)
+{
+    if (i2c.running && (i2c.doneAt <= stats.now))
+    {
+        i2c.running = false;
+        I2C_REG(I2C_O_MRIS) = I2C_MRIS_RIS;
+    }
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        Timer *timer = &timers[i];
+        if (timer->enabled && (timer->config == TIMER_CFG_ONE_SHOT) && ((timer->start + timer->load) <= stats.now))
+        {
+            timer->enabled = false;
+            timer->raw |= TIMER_TIMA_TIMEOUT;
+        }
+        if (timer->matchAt <= stats.now)
+        {
+            timer->raw |= TIMER_TIMA_MATCH;
+            armMatch(timer);
+        }
+    }
+}
+
+/**
+* @brief call handler in interrupt context
+*/
+static void callHandler(void (*handler)(void), uint32_t *counter)
+{
+    inInterrupt = true;
+    handler();
+    inInterrupt = false;
+    (*counter)++;
+}
+
+/**
+* @brief run handlers of pending interrupts, I2C1 has the highest priority
+*/
+static void dispatch(void)
+{
+    if (inInterrupt)
+    {
+        return;
+    }
+
+    for (uint32_t calls = 0; calls < MOCK_MAX_NESTED; calls++)
+    {
+        if ((I2C_REG(I2C_O_MRIS) & I2C_REG(I2C_O_MIMR) & I2C_MRIS_RIS) && (i2c.handler != NULL))
+        {
+            callHandler(i2c.handler, &stats.i2cInterrupts);
+            continue;
+        }
+
+        bool called = false;
+        for (uint8_t i = 0; (i < 2) && !called; i++)
+        {
+            Timer *timer = &timers[i];
+            if (((timer->raw & timer->mask) || timer->pended) && (timer->handler != NULL))
+            {
+                timer->pended = false;
+                callHandler(timer->handler, &stats.timerInterrupts);
+                called = true;
+            }
+        }
+        if (!called)
+        {
+            return;
+        }
+    }
+
+    //handler which doesn't clear its interrupt would run forever
+    stats.violations++;
+}
+
+/**
+* @brief move virtual time, events on the way are processed in order
+*/
+static void advanceTo(uint64_t time)
+{
+    for (uint64_t next = nextEvent(); next <= time; next = nextEvent())
+    {
+        stats.now = (next > stats.now) ? next : stats.now;
+        processEvents();
+        dispatch();
+    }
+
+    stats.now = (time > stats.now) ? time : stats.now;
+    dispatch();
+}
+
+void mockRun(uint32_t maxUs)
+{
+    const uint64_t limit = stats.now + ((uint64_t)maxUs * (MOCK_CLOCK_HZ / 1000000));
+
+    dispatch();
+    for (uint64_t next = nextEvent(); (next != MOCK_NEVER) && (next <= limit); next = nextEvent())
+    {
+        advanceTo(next);
+    }
+}
+
+/**
+* @brief slave receives byte, the first one is pointer register
+*/
+static void slaveWrite(MockSlave *slave, uint8_t byte)
+{
+    if (slave->byteIndex == 0)
+    {
+        slave->pointer = byte;
+    }
+    else
+    {
+        slave->value = (uint16_t)((slave->value << 8) | byte);
+    }
+
+    if (++slave->byteIndex == 3)
+    {
+        //reset bit returns CONFIG to its power on value
+        if (slave->pointer == 0x02)
+        {
+            slave->regs[0x02] = (slave->value & 0x8000) ? 0x7400 : (slave->value & 0x7F00);
+        }
+        slave->writes++;
+        slave->byteIndex = 1;
+    }
+}
+
+/**
+* @brief slave sends byte of register pointer register points to, MSB first
+*/
+static uint8_t slaveRead(MockSlave *slave)
+{
+    const uint16_t value = slave->regs[slave->pointer];
+
+    return (slave->byteIndex++ & 1) ? (uint8_t)value : (uint8_t)(value >> 8);
+}
+
+void SysCtlClockSet(uint32_t ui32Config)
+{
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    stats.clockReads++;
+
+    return MOCK_CLOCK_HZ;
+}
+
+void SysCtlDelay(uint32_t ui32Count)
+{
+    advanceTo(stats.now + (3 * (uint64_t)ui32Count));
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    return true;
+}
+
+void SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+    if (ui32Peripheral == SYSCTL_PERIPH_I2C1)
+    {
+        resetI2c();
+    }
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+}
+
+void GPIOUnlockPin(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeGPIOOutputOD(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    if ((ui32Port == GPIO_PORTA_BASE) && (ui8Pins & (GPIO_PIN_6 | GPIO_PIN_7)))
+    {
+        i2c.pinsGpio = true;
+    }
+}
+
+void GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    if (ui32Port == GPIO_PORTA_BASE)
+    {
+        i2c.pinsGpio = false;
+    }
+}
+
+void GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    if (ui32Port == GPIO_PORTA_BASE)
+    {
+        i2c.pinsGpio = false;
+    }
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength, uint32_t ui32PadType)
+{
+}
+
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    if (ui32Port != GPIO_PORTA_BASE)
+    {
+        return 0;
+    }
+
+    //open drain, slave which holds SDA wins
+    const uint8_t levels = i2c.sdaHeld ? (i2c.pins & (uint8_t)~GPIO_PIN_7) : i2c.pins;
+
+    return levels & ui8Pins;
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    if ((ui32Port != GPIO_PORTA_BASE) || !i2c.pinsGpio)
+    {
+        return;
+    }
+
+    const uint8_t before = (uint8_t)GPIOPinRead(GPIO_PORTA_BASE, GPIO_PIN_6 | GPIO_PIN_7);
+    i2c.pins = (uint8_t)((i2c.pins & ~ui8Pins) | (ui8Val & ui8Pins)) & (GPIO_PIN_6 | GPIO_PIN_7);
+
+    //slave shifts out the rest of its byte on SCL clocks, SDA changes while SCL is low
+    if (i2c.sdaHeld && !(before & GPIO_PIN_6) && (i2c.pins & GPIO_PIN_6) && (i2c.holdClocks > 0))
+    {
+        i2c.holdClocks--;
+    }
+    if (i2c.sdaHeld && (before & GPIO_PIN_6) && !(i2c.pins & GPIO_PIN_6) && (i2c.holdClocks == 0))
+    {
+        i2c.sdaHeld = false;
+        return;
+    }
+
+    //SDA rising while SCL is high is stop condition
+    const uint8_t after = (uint8_t)GPIOPinRead(GPIO_PORTA_BASE, GPIO_PIN_6 | GPIO_PIN_7);
+    if ((after & GPIO_PIN_6) && !(before & GPIO_PIN_7) && (after & GPIO_PIN_7))
+    {
+        stats.busClears++;
+        stats.busOwned = false;
+    }
+}
+
+void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void))
+{
+}
+
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+}
+
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+}
+
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+}
+
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+}
+
+uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked)
+{
+    return 0;
+}
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    Timer *timer = timerOf(ui32Base);
+
+    timer->config = ui32Config;
+    timer->enabled = false;
+    timer->matchAt = MOCK_NEVER;
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    Timer *timer = timerOf(ui32Base);
+
+    timer->enabled = true;
+    timer->start = stats.now;
+    armMatch(timer);
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    Timer *timer = timerOf(ui32Base);
+
+    timer->enabled = false;
+    timer->matchAt = MOCK_NEVER;
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    timerOf(ui32Base)->load = ui32Value;
+}
+
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    const Timer *timer = timerOf(ui32Base);
+    const uint64_t elapsed = timer->enabled ? (stats.now - timer->start) : 0;
+
+    if (timer->config == TIMER_CFG_PERIODIC_UP)
+    {
+        return (uint32_t)elapsed;
+    }
+
+    return (elapsed < timer->load) ? (uint32_t)(timer->load - elapsed) : 0;
+}
+
+void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    Timer *timer = timerOf(ui32Base);
+
+    timer->match = ui32Value;
+    armMatch(timer);
+}
+
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer, void (*pfnHandler)(void))
+{
+    timerOf(ui32Base)->handler = pfnHandler;
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    Timer *timer = timerOf(ui32Base);
+
+    timer->mask |= ui32IntFlags;
+    armMatch(timer);
+}
+
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    Timer *timer = timerOf(ui32Base);
+
+    timer->mask &= ~ui32IntFlags;
+    armMatch(timer);
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    timerOf(ui32Base)->raw &= ~ui32IntFlags;
+}
+
+void I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast)
+{
+    const uint32_t sclFreq = bFast ? 400000 : 100000;
+
+    I2C_REG(I2C_O_MTPR) = ((ui32I2CClk + (2 * 10 * sclFreq) - 1) / (2 * 10 * sclFreq)) - 1;
+    i2c.enabled = true;
+}
+
+void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive)
+{
+    I2C_REG(I2C_O_MSA) = ((uint32_t)ui8SlaveAddr << 1) | (bReceive ? 1 : 0);
+}
+
+void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data)
+{
+    I2C_REG(I2C_O_MDR) = ui8Data;
+}
+
+uint32_t I2CMasterDataGet(uint32_t ui32Base)
+{
+    return I2C_REG(I2C_O_MDR);
+}
+
+void I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd)
+{
+    stats.commands++;
+    if (!i2c.enabled || i2c.running || i2c.pinsGpio)
+    {
+        stats.violations++;
+        return;
+    }
+
+    const bool fault = (i2c.fault != MOCK_FAULT_NONE) && (i2c.faultAt-- == 0);
+    const enum MockI2cFault kind = fault ? i2c.fault : MOCK_FAULT_NONE;
+    i2c.fault = fault ? MOCK_FAULT_NONE : i2c.fault;
+
+    if (!(ui32Cmd & I2C_MCS_RUN))
+    {
+        //stop after error, it's harmless when bus is already free
+        if (ui32Cmd & I2C_MCS_STOP)
+        {
+            stats.busOwned = false;
+            i2c.addressed = NULL;
+        }
+        return;
+    }
+
+    const bool receive = I2C_REG(I2C_O_MSA) & 1;
+    uint32_t bits = 0;
+    uint32_t error = 0;
+
+    if (ui32Cmd & I2C_MCS_START)
+    {
+        bits += 1 + 9;
+        stats.busOwned = true;
+        i2c.addressed = mockSlave((uint8_t)(I2C_REG(I2C_O_MSA) >> 1));
+        if (kind == MOCK_FAULT_ARB_LOST)
+        {
+            error = I2C_MCS_ARBLST | I2C_MCS_ERROR;
+        }
+        else if ((i2c.addressed == NULL) || !i2c.addressed->present)
+        {
+            error = I2C_MCS_ADRACK | I2C_MCS_ERROR;
+        }
+        else
+        {
+            i2c.addressed->byteIndex = 0;
+        }
+    }
+    else if (!stats.busOwned || (i2c.addressed == NULL))
+    {
+        //data byte without start, or after address wasn't acknowledged
+        stats.violations++;
+        return;
+    }
+
+    if (error == 0)
+    {
+        bits += 9;
+        if (kind == MOCK_FAULT_ARB_LOST)
+        {
+            error = I2C_MCS_ARBLST | I2C_MCS_ERROR;
+        }
+        else if (receive)
+        {
+            I2C_REG(I2C_O_MDR) = slaveRead(i2c.addressed);
+        }
+        else if (kind == MOCK_FAULT_DATA_NACK)
+        {
+            error = I2C_MCS_DATACK | I2C_MCS_ERROR;
+        }
+        else
+        {
+            slaveWrite(i2c.addressed, (uint8_t)I2C_REG(I2C_O_MDR));
+        }
+    }
+
+    //master which lost arbitration doesn't own the bus anymore
+    if (error & I2C_MCS_ARBLST)
+    {
+        stats.busOwned = false;
+        i2c.addressed = NULL;
+    }
+    else if ((ui32Cmd & I2C_MCS_STOP) && (error == 0))
+    {
+        bits += 1;
+        stats.busOwned = false;
+        i2c.addressed = NULL;
+    }
+
+    if (kind == MOCK_FAULT_STUCK)
+    {
+        i2c.sdaHeld = true;
+    }
+
+    const uint64_t duration = (uint64_t)bits * 20 * ((I2C_REG(I2C_O_MTPR) & 0x7F) + 1);
+    stats.busCycles += duration;
+    i2c.error = error;
+    i2c.running = true;
+    i2c.doneAt = i2c.sdaHeld ? MOCK_NEVER : (stats.now + duration);
+}
+
+bool I2CMasterBusy(uint32_t ui32Base)
+{
+    return i2c.running;
+}
+
+uint32_t I2CMasterErr(uint32_t ui32Base)
+{
+    if (i2c.running || !(i2c.error & (I2C_MCS_ERROR | I2C_MCS_ARBLST)))
+    {
+        return I2C_MASTER_ERR_NONE;
+    }
+
+    return i2c.error & (I2C_MCS_ARBLST | I2C_MCS_DATACK | I2C_MCS_ADRACK);
+}
+
+void I2CMasterIntEnable(uint32_t ui32Base)
+{
+    I2C_REG(I2C_O_MIMR) = I2C_MIMR_IM;
+}
+
+void I2CMasterIntDisable(uint32_t ui32Base)
+{
+    I2C_REG(I2C_O_MIMR) = 0;
+}
+
+void I2CMasterIntClear(uint32_t ui32Base)
+{
+    I2C_REG(I2C_O_MRIS) = 0;
+}
+
+void I2CIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    i2c.handler = pfnHandler;
+}
+
+void IntPendSet(uint32_t ui32Interrupt)
+{
+    if (ui32Interrupt == INT_TIMER0A)
+    {
+        timers[0].pended = true;
+    }
+    else if (ui32Interrupt == INT_TIMER1A)
+    {
+        timers[1].pended = true;
+    }
+    dispatch();
+}
+
+bool IntMasterEnable(void)
+{
+    return false;
+}
+
+bool IntMasterDisable(void)
+{
+    return false;
+}
+
+uint32_t CPUcpsid(void)
+{
+    return 0;
+}
+
+uint32_t CPUcpsie(void)
+{
+    return 0;
+}
+
+void CPUwfi(void)
+{
+    const uint64_t next = nextEvent();
+
+    if (next != MOCK_NEVER)
+    {
+        advanceTo(next);
+    }
+}
+
+void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud, uint32_t ui32SrcClock)
+{
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    va_list args;
+
+    va_start(args, pcString);
+    vprintf(pcString, args);
+    va_end(args);
+}
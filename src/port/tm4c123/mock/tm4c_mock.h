@@ -0,0 +1,110 @@
+/**
+* @file tm4c_mock.h
+* @brief Register model of the TivaWare driverlib parts used by the tm4c123 port
+*
+* I2C1 master, Timer0, Timer1, GPIO and interrupt controller are modelled on
+* virtual time counted in system clock cycles, so tm4c_init.c and tm4c_i2c.c
+* run unchanged on a Linux host. TMP006 slaves answer on the bus, faults of
+* the bus are injected by the test.
+*
+* Time moves only in SysCtlDelay(), CPUwfi() and mockRun(). Interrupt handler
+* runs at the moment its event happens, handlers don't preempt each other.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TM4C_MOCK_H
+#define  TM4C_MOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief System clock of the model, the one initSystemClock_40MHz() sets */
+#define MOCK_CLOCK_HZ       40000000u
+
+/** @brief Time of event which will never happen */
+#define MOCK_NEVER          UINT64_MAX
+
+/**
+* @brief Fault of the bus, injected into one master command
+*/
+enum MockI2cFault
+{
+    MOCK_FAULT_NONE,
+    MOCK_FAULT_DATA_NACK,   /**< Slave doesn't acknowledge data byte of the command */
+    MOCK_FAULT_ARB_LOST,    /**< Another master wins the bus, master releases it */
+    MOCK_FAULT_STUCK        /**< Slave holds SDA low, command never finishes */
+};
+
+/**
+* @brief Simulated TMP006 slave
+*/
+typedef struct MockSlave
+{
+    bool     present;    /**< Slave acknowledges its address */
+    uint16_t regs[256];  /**< Registers, CONFIG is the only writable one */
+    uint8_t  pointer;    /**< Pointer register */
+    uint8_t  byteIndex;  /**< Byte of current transfer */
+    uint16_t value;      /**< Received bytes of register write */
+    uint32_t writes;     /**< Number of register writes */
+} MockSlave;
+
+/**
+* @brief Counters of the model
+*/
+typedef struct MockStats
+{
+    uint64_t now;             /**< Virtual time in system clock cycles */
+    uint64_t busCycles;       /**< Cycles in which master commands drove the bus */
+    uint32_t commands;        /**< Master commands written to MCS */
+    uint32_t i2cInterrupts;   /**< Calls of i2c1 handler */
+    uint32_t timerInterrupts; /**< Calls of timer handlers */
+    uint32_t clockReads;      /**< Calls of SysCtlClockGet() */
+    uint32_t busClears;       /**< Stop conditions generated with pins in GPIO mode */
+    uint32_t violations;      /**< Commands master wasn't allowed to issue, must stay 0 */
+    bool     busOwned;        /**< Master holds the bus, start was sent without stop */
+} MockStats;
+
+/**
+* @brief Reset the model, time starts at 0 and only slave 0x40 is present.
+*
+* Slaves hold manufacturer and device ID, CONFIG 0x7400, VOBJECT 0 and
+* TAMBIENT of 25 C.
+*/
+void mockReset(void);
+
+/**
+* @brief Run virtual time until no event is left or time limit is reached.
+*
+* @param maxUs The longest run in microseconds
+*/
+void mockRun(uint32_t maxUs);
+
+/**
+* @brief Get slave at address 0x40 - 0x47, NULL for other addresses
+*/
+MockSlave *mockSlave(uint8_t address);
+
+/**
+* @brief Inject fault into master command.
+*
+* @param fault Fault, MOCK_FAULT_NONE removes injected one
+* @param command Number of command, counted from 0 for the next one
+* @param holdClocks For MOCK_FAULT_STUCK, number of SCL clocks after which slave releases SDA
+*/
+void mockI2cFault(enum MockI2cFault fault, uint32_t command, uint8_t holdClocks);
+
+/**
+* @brief Get counters of the model
+*/
+const MockStats *mockStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TM4C_MOCK_H
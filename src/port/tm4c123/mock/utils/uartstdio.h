@@ -0,0 +1,19 @@
+/**
+* @file uartstdio.h
+* @brief Host stand-in of TivaWare utils/uartstdio.h
+*
+* Only what the tm4c123 port uses, values are the ones of TivaWare 2.2.
+* Functions are implemented by the register model in tm4c_mock.c.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef __UARTSTDIO_H__
+#define  __UARTSTDIO_H__
+
+#include <stdint.h>
+
+void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud, uint32_t ui32SrcClock);
+void UARTprintf(const char *pcString, ...);
+
+#endif //__UARTSTDIO_H__
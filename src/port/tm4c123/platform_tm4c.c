@@ -6,30 +6,93 @@
 */
 
 #include "tm4c_init.h"
+#include "tm4c_i2c.h"
 #include "platform.h"
+#include <errno.h>
+#include <stddef.h>
+
+typedef void (*platform_InterruptHandler)(void);
+
+static volatile platform_InterruptHandler alarmCallback;
+static volatile uint32_t alarmTimestamp;
+
+/**
+* @brief Match interrupt handler of timestamp timer
+* @note Interrupt is pended by software too, when alarm is already due.
+*/
+static void alarmHandler(void)
+{
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+    
+    const platform_InterruptHandler callback = alarmCallback;
+    //pended interrupt of alarm which was replaced meanwhile
+    if ((callback == NULL) || ((int32_t)(timestampCounter() - alarmTimestamp) < 0))
+    {
+        return;
+    }
+    
+    //alarm is one-shot, callback can set the next one
+    alarmCallback = NULL;
+    timerCancelAlarm();
+    callback();
+    signalEvent();
+}
 
 int platform_init(void)
 {
     initSystemClock_40MHz();
+    initCycleCounter();
+    initTimestampTimer(alarmHandler);
     enablePeripheralsClock();
     initI2c();
+    initI2cInterrupt();
     initUartPrintf();
     
     return 0;
 }
 
-typedef void (*platform_InterruptHandler)(void);
+uint32_t platform_timestamp(void)
+{
+    return timestampCounter();
+}
+
+uint32_t platform_timestampHz(void)
+{
+    return timestampFrequency();
+}
+
+int platform_scheduleAt(uint32_t timestamp, void (*handler)(void))
+{
+    //match interrupt already pending must not run new callback at old time
+    const uint32_t masked = CPUcpsid();
+    timerCancelAlarm();
+    alarmTimestamp = timestamp;
+    alarmCallback = handler;
+    
+    if (handler != NULL)
+    {
+        timerSetAlarm(timestamp);
+    }
+    if (!masked)
+    {
+        CPUcpsie();
+    }
+    
+    return 0;
+}
 
 static platform_InterruptHandler timerCallback;
 
+/** @brief timestamp of next millisecond tick */
+static uint32_t nextTick;
+
 /**
-* @brief Timer interrupt handler
-* @note TimerIntClear() is optionl and it depends on used platform.
+* @brief Millisecond tick, next one is counted from this one so ticks don't drift
 */
 static void timerHandler(void)
 {
-    //clear interrupt 
-    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+    nextTick += platform_timestampHz() / 1000;
+    platform_scheduleAt(nextTick, timerHandler);
     
     timerCallback();    
 }
@@ -38,9 +101,14 @@ int platform_configure1msInterrupt(void (*interruptHandler)(void))
 {
     timerCallback = interruptHandler;
     
-    initTimer1mSec(timerHandler);
+    if (interruptHandler == NULL)
+    {
+        return platform_scheduleAt(0, NULL);
+    }
     
-    return 0;
+    nextTick = platform_timestamp() + (platform_timestampHz() / 1000);
+    
+    return platform_scheduleAt(nextTick, timerHandler);
 }
 
 static platform_InterruptHandler interruptPinCallback;
@@ -55,6 +123,7 @@ static void interruptPinHandler (void)
     GPIOIntClear(GPIO_PORTA_BASE, GPIO_INT_PIN_2);
     
     interruptPinCallback();
+    signalEvent();
 }
 
 int platform_configureInterruptPin(void (*interruptHandler)(void))
@@ -66,11 +135,109 @@ int platform_configureInterruptPin(void (*interruptHandler)(void))
     return 0;
 }
 
+/**
+* @brief DRDY pin of each device on DRDY_PORT_BASE, position in table is address - 0x40
+* @note PB6 and PB7 are connected to PD0 and PD1 on LaunchPad, R9 and R10 have to be removed.
+*/
+static const uint8_t drdyPins[PLATFORM_DRDY_MAX_PINS] = {
+    GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_4, GPIO_PIN_5, GPIO_PIN_6, GPIO_PIN_7
+};
+
+static uint8_t drdyPinCount;
+static void (*drdyCallback)(uint8_t readyMask);
+
+/**
+* @brief Port interrupt handler of DRDY pins
+* @note Status is read once, edge which comes after the read interrupts again.
+*/
+static void drdyPortHandler(void)
+{
+    const uint32_t status = GPIOIntStatus(DRDY_PORT_BASE, true);
+    GPIOIntClear(DRDY_PORT_BASE, status);
+    
+    uint8_t readyMask = 0;
+    for (uint8_t i = 0; i < drdyPinCount; i++)
+    {
+        if (status & drdyPins[i])
+        {
+            readyMask |= (uint8_t)(1 << i);
+        }
+    }
+    
+    if (readyMask != 0)
+    {
+        drdyCallback(readyMask);
+        signalEvent();
+    }
+}
+
+int platform_configureDrdyPins(uint8_t pinCount, void (*interruptHandler)(uint8_t readyMask))
+{
+    if ((pinCount == 0) || (pinCount > PLATFORM_DRDY_MAX_PINS) || (interruptHandler == NULL))
+    {
+        return -EINVAL;
+    }
+    
+    uint8_t pins = 0;
+    for (uint8_t i = 0; i < pinCount; i++)
+    {
+        pins |= drdyPins[i];
+    }
+    
+    drdyCallback = interruptHandler;
+    drdyPinCount = pinCount;
+    initDrdyPort(pins, drdyPortHandler);
+    
+    return 0;
+}
+
+void platform_idle(void)
+{
+    //interrupts and timer run on their own, busy-wait loops must not be slowed down
+}
+
 int platform_i2cRead(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
 {
     return i2cRead(slaveAddr, reg, data, length);
 }
 
+int platform_i2cReadCurrent(uint8_t slaveAddr, uint8_t *data, uint16_t length)
+{
+    return i2cReadCurrent(slaveAddr, data, length);
+}
+
+int platform_i2cStart(TMP006_Transaction *txn)
+{
+    return i2cStart(txn);
+}
+
+int platform_i2cSubmit(TMP006_Transaction *txns, uint16_t count,
+                       void (*done)(TMP006_Transaction *txns, uint16_t count, void *context),
+                       void *context)
+{
+    return i2cSubmit(txns, count, done, context);
+}
+
+void platform_waitForEvent(void)
+{
+    waitForEvent();
+}
+
+uint32_t platform_cycles(void)
+{
+    return cycleCounter();
+}
+
+uint64_t platform_cyclesToNs(uint32_t cycles)
+{
+    return cyclesToNs(cycles);
+}
+
+uint32_t platform_i2cSetSpeed(uint32_t speedHz)
+{
+    return i2cSetSpeed(speedHz);
+}
+
 int platform_i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
 {
     return i2cWrite(slaveAddr, reg, data, length);
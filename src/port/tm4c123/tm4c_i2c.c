@@ -0,0 +1,245 @@
+/**
+* @file tm4c_i2c.c
+* @brief interrupt driven i2c master for tm4c123g
+*
+* Every step of transaction (pointer write, repeated start, each data byte)
+* is started from the i2c1 interrupt of the previous one, so CPU is free
+* while bytes are on the bus.
+*
+* @author Zarko Milojicic
+*/
+#define PART_TM4C123GH6PM
+
+#include "tm4c_i2c.h"
+#include "tm4c_init.h"
+#include <errno.h>
+#include <stddef.h>
+
+/**
+* @brief state of i2c master
+*/
+enum I2cState
+{
+    I2C_STATE_IDLE,
+    I2C_STATE_REG_SENT,   /**< start, address and register sent */
+    I2C_STATE_WRITING,    /**< sending data bytes */
+    I2C_STATE_READING     /**< receiving data bytes */
+};
+
+/** @brief number of data bytes in TMP006 register */
+#define I2C_TXN_LENGTH  2
+
+static volatile enum I2cState state = I2C_STATE_IDLE;
+static TMP006_Transaction *volatile current;
+static uint16_t byteIndex;
+
+/** @brief Timer1 ticks per microsecond, SysCtlClockGet() is too slow for interrupt */
+static uint32_t ticksPerUs;
+
+/** @brief queue of transactions submitted by i2cSubmit() */
+static TMP006_Transaction *volatile batch;
+static uint16_t batchCount;
+static uint16_t batchIndex;
+static i2cBatchCallback batchDone;
+static void *batchContext;
+
+static void begin(TMP006_Transaction *txn);
+
+/**
+* @brief end transaction, notify the driver and continue with the queue
+*/
+static void finish(int status)
+{
+    TMP006_Transaction *txn = current;
+    
+    TimerDisable(TIMER1_BASE, TIMER_A);
+    current = NULL;
+    state = I2C_STATE_IDLE;
+    tmp006_complete(txn, status);
+    signalEvent();
+    
+    if (batch == NULL)
+    {
+        return;
+    }
+    
+    //next transaction starts right away, failed one doesn't stop the queue
+    if (++batchIndex < batchCount)
+    {
+        begin(&batch[batchIndex]);
+        return;
+    }
+    
+    TMP006_Transaction *txns = batch;
+    batch = NULL;
+    batchDone(txns, batchCount, batchContext);
+}
+
+/**
+* @brief start receiving data bytes
+*/
+static void startReading(uint8_t slaveAddr)
+{
+    state = I2C_STATE_READING;
+    byteIndex = 0;
+    
+    I2CMasterSlaveAddrSet(I2C1_BASE, slaveAddr, true);
+    I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_START);
+}
+
+void i2cInterruptHandler(void)
+{
+    I2CMasterIntClear(I2C1_BASE);
+    
+    if (state == I2C_STATE_IDLE)
+    {
+        return;
+    }
+    
+    int status = i2cMasterError(state == I2C_STATE_READING);
+    if (status != 0)
+    {
+        finish(status);
+        return;
+    }
+    
+    TMP006_Transaction *txn = current;
+    switch (state)
+    {
+        case I2C_STATE_REG_SENT:
+        {
+            if (txn->type == TMP006_TXN_WRITE)
+            {
+                state = I2C_STATE_WRITING;
+                byteIndex = 1;
+                I2CMasterDataPut(I2C1_BASE, txn->data[0]);
+                I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
+            }
+            else
+            {
+                //repeated start
+                startReading(txn->addr);
+            }
+            break;
+        }
+        case I2C_STATE_WRITING:
+        {
+            if (byteIndex == I2C_TXN_LENGTH)
+            {
+                finish(0);
+                break;
+            }
+            I2CMasterDataPut(I2C1_BASE, txn->data[byteIndex++]);
+            I2CMasterControl(I2C1_BASE, (byteIndex == I2C_TXN_LENGTH) ?
+                                        I2C_MASTER_CMD_BURST_SEND_FINISH :
+                                        I2C_MASTER_CMD_BURST_SEND_CONT);
+            break;
+        }
+        case I2C_STATE_READING:
+        {
+            txn->data[byteIndex++] = (uint8_t)I2CMasterDataGet(I2C1_BASE);
+            if (byteIndex == I2C_TXN_LENGTH)
+            {
+                finish(0);
+                break;
+            }
+            I2CMasterControl(I2C1_BASE, (byteIndex == (I2C_TXN_LENGTH - 1)) ?
+                                        I2C_MASTER_CMD_BURST_RECEIVE_FINISH :
+                                        I2C_MASTER_CMD_BURST_RECEIVE_CONT);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+/**
+* @brief put first byte of transaction on the bus
+*/
+static void begin(TMP006_Transaction *txn)
+{
+    current = txn;
+    
+    const uint32_t timeout = (txn->timeoutUs != 0) ? txn->timeoutUs : I2C_DEFAULT_TIMEOUT_US;
+    TimerLoadSet(TIMER1_BASE, TIMER_A, ticksPerUs * timeout);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+    
+    if (txn->type == TMP006_TXN_READ_CURRENT)
+    {
+        startReading(txn->addr);
+        return;
+    }
+    
+    state = I2C_STATE_REG_SENT;
+    I2CMasterSlaveAddrSet(I2C1_BASE, txn->addr, false);
+    I2CMasterDataPut(I2C1_BASE, txn->reg);
+    I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_SEND_START);
+}
+
+int i2cStart(TMP006_Transaction *txn)
+{
+    if ((state != I2C_STATE_IDLE) || (batch != NULL))
+    {
+        return -EBUSY;
+    }
+    
+    begin(txn);
+    
+    return 0;
+}
+
+int i2cSubmit(TMP006_Transaction *txns, uint16_t count, i2cBatchCallback done, void *context)
+{
+    if ((txns == NULL) || (count == 0) || (done == NULL))
+    {
+        return -EINVAL;
+    }
+    if ((state != I2C_STATE_IDLE) || (batch != NULL))
+    {
+        return -EBUSY;
+    }
+    
+    batchCount = count;
+    batchIndex = 0;
+    batchDone = done;
+    batchContext = context;
+    batch = txns;
+    begin(&txns[0]);
+    
+    return 0;
+}
+
+/**
+* @brief deadline of transaction expired, bus is freed and transaction fails
+*/
+static void timeoutHandler(void)
+{
+    TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    
+    if (state == I2C_STATE_IDLE)
+    {
+        return;
+    }
+    
+    i2cBusRecover();
+    finish(-ETIMEDOUT);
+}
+
+void initI2cInterrupt(void)
+{
+    I2CIntRegister(I2C1_BASE, i2cInterruptHandler);
+    I2CMasterIntClear(I2C1_BASE);
+    I2CMasterIntEnable(I2C1_BASE);
+    
+    //Timer1 measures deadline of transaction
+    ticksPerUs = SysCtlClockGet() / 1000000;
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1))
+    {
+    }
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_ONE_SHOT);
+    TimerIntRegister(TIMER1_BASE, TIMER_A, timeoutHandler);
+    TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+}
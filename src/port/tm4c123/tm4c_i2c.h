@@ -0,0 +1,65 @@
+/**
+* @file tm4c_i2c.h
+* @brief interrupt driven i2c master for tm4c123g
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TM4C123_I2C_H
+#define  TM4C123_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../tmp006/tmp006.h"
+
+/**
+* @brief init of i2c1 interrupt, initI2c() must be called first
+*/
+void initI2cInterrupt(void);
+
+/**
+* @brief start transaction, it's performed byte by byte from i2c1 interrupt
+* 
+* When transaction is finished tmp006_complete() is called from interrupt.
+* If it isn't finished in txn->timeoutUs (I2C_DEFAULT_TIMEOUT_US if 0), the bus
+* is recovered by i2cBusRecover() and transaction fails with -ETIMEDOUT, so worst
+* case duration of failed transaction is its deadline plus about 100 us.
+* 
+* @param txn pointer to transaction, must be valid until it's finished
+* @return 0 if transaction is started, -EBUSY if another one is in progress
+*/
+int i2cStart(TMP006_Transaction *txn);
+
+/**
+* @brief function called when all transactions submitted by i2cSubmit() are finished
+*/
+typedef void (*i2cBatchCallback)(TMP006_Transaction *txns, uint16_t count, void *context);
+
+/**
+* @brief queue array of transactions, they are performed back-to-back from interrupt
+* 
+* tmp006_complete() is called for every transaction, done is called once at the end.
+* 
+* @param txns array of transactions, must be valid until done is called
+* @param count number of transactions
+* @param done function called when all transactions are finished
+* @param context user data for done
+* @return 0 if transactions are queued, -EBUSY if another transaction is in progress
+*/
+int i2cSubmit(TMP006_Transaction *txns, uint16_t count, i2cBatchCallback done, void *context);
+
+/**
+* @brief i2c1 interrupt handler, steps the state machine
+*/
+void i2cInterruptHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TM4C123_I2C_H
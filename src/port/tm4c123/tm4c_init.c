@@ -7,8 +7,12 @@
 #define PART_TM4C123GH6PM
 
 #include "tm4c_init.h"
+#include <errno.h>
 #include "../inc/hw_i2c.h"
+#include "../inc/hw_ints.h"
+#include "../inc/hw_timer.h"
 #include "../inc/hw_types.h"
+#include "../driverlib/interrupt.h"
 //#include "../inc/hw_gpio.h"
 #include "../driverlib/pin_map.h"
 
@@ -45,7 +49,28 @@ void initPorts(void (*portA2IntHandler)(void))
     GPIOIntEnable(GPIO_PORTA_BASE, GPIO_PIN_2);   
 }
 
-void initTimer1mSec(void (*pfnHandler)(void))
+void initDrdyPort(uint8_t pins, void (*portIntHandler)(void))
+{
+    SysCtlPeripheralEnable(DRDY_PORT_PERIPH);
+    while(!SysCtlPeripheralReady(DRDY_PORT_PERIPH))
+    {
+    }
+    
+    //DRDY is open drain, weak pull-up is enough for edge detection
+    GPIOPinTypeGPIOInput(DRDY_PORT_BASE, pins);
+    GPIOPadConfigSet(DRDY_PORT_BASE, pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+    
+    // One handler for all pins of the port, edges which came before are dropped
+    GPIOIntRegister(DRDY_PORT_BASE, portIntHandler);
+    GPIOIntTypeSet(DRDY_PORT_BASE, pins, GPIO_FALLING_EDGE);
+    GPIOIntClear(DRDY_PORT_BASE, pins);
+    GPIOIntEnable(DRDY_PORT_BASE, pins);
+}
+
+/** @brief frequency of Timer0, SysCtlClockGet() is slow */
+static uint32_t timestampHz;
+
+void initTimestampTimer(void (*pfnHandler)(void))
 {
     // Enable the Timer0 peripheral
     SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
@@ -55,21 +80,110 @@ void initTimer1mSec(void (*pfnHandler)(void))
     {
     }
 
-    // Configure Timer0 as a full-width periodic timer
-    TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);    
+    // Configure Timer0 as a full-width timer counting up through all 32 bits
+    TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC_UP);
+    TimerLoadSet(TIMER0_BASE, TIMER_A, 0xFFFFFFFF);
+    timestampHz = SysCtlClockGet();
 
-    // Set the count time for the the periodic timer (TimerA).
-    //1ms sec
-    TimerLoadSet(TIMER0_BASE, TIMER_A, 40000);
-    
+    //match interrupt is the only one, it's enabled while alarm is set
+    HWREG(TIMER0_BASE + TIMER_O_TAMR) |= TIMER_TAMR_TAMIE;
     TimerIntRegister(TIMER0_BASE, TIMER_A, pfnHandler);
-    
-    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
 
     TimerEnable(TIMER0_BASE, TIMER_A); 
 }
 
-void initI2c()
+uint32_t timestampCounter(void)
+{
+    return TimerValueGet(TIMER0_BASE, TIMER_A);
+}
+
+uint32_t timestampFrequency(void)
+{
+    return timestampHz;
+}
+
+void timerSetAlarm(uint32_t timestamp)
+{
+    TimerMatchSet(TIMER0_BASE, TIMER_A, timestamp);
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_MATCH);
+
+    //value passed before match was set would match only after the counter wraps
+    if ((int32_t)(timestampCounter() - timestamp) >= 0)
+    {
+        IntPendSet(INT_TIMER0A);
+    }
+}
+
+void timerCancelAlarm(void)
+{
+    TimerIntDisable(TIMER0_BASE, TIMER_TIMA_MATCH);
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+}
+
+/** @brief set by interrupt handlers, cleared when main loop wakes */
+static volatile bool eventPending;
+
+void signalEvent(void)
+{
+    eventPending = true;
+}
+
+void waitForEvent(void)
+{
+    CPUcpsid();
+    if (!eventPending)
+    {
+        CPUwfi();
+        //handler of the interrupt which woke the core runs here
+        CPUcpsie();
+        CPUcpsid();
+    }
+    eventPending = false;
+    CPUcpsie();
+}
+
+/**@{ Registers of DWT cycle counter, they are not in TivaWare headers */
+#define CORE_DEMCR          0xE000EDFC
+#define CORE_DEMCR_TRCENA   0x01000000
+#define DWT_CTRL            0xE0001000
+#define DWT_CTRL_CYCCNTENA  0x00000001
+#define DWT_CYCCNT          0xE0001004
+/**@}*/
+
+/** @brief nanoseconds per system clock cycle, 16 fractional bits */
+static uint32_t nsPerCycleQ16;
+
+void initCycleCounter(void)
+{
+    //conversion factor is computed once, SysCtlClockGet() is slow
+    nsPerCycleQ16 = (uint32_t)((1000000000ull << 16) / SysCtlClockGet());
+
+    HWREG(CORE_DEMCR) |= CORE_DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t cycleCounter(void)
+{
+    return HWREG(DWT_CYCCNT);
+}
+
+uint64_t cyclesToNs(uint32_t cycles)
+{
+    return ((uint64_t)cycles * nsPerCycleQ16) >> 16;
+}
+
+/** @brief SCL rate, kept when i2c module is initialized again */
+static uint32_t i2cSpeed = I2C_INIT_SPEED;
+
+/** @brief system clock of i2c timing, SysCtlClockGet() is slow */
+static uint32_t i2cClockHz;
+
+/**
+* @brief init i2c module and its pins with cached system clock, also used by bus recovery
+*/
+static void initI2cModule(void)
 {
     //enable I2C module 1
     SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C1);
@@ -91,46 +205,175 @@ void initI2c()
     GPIOPinTypeI2CSCL(GPIO_PORTA_BASE, GPIO_PIN_6);
     GPIOPinTypeI2C(GPIO_PORTA_BASE, GPIO_PIN_7);
 
-    //100kbs
-    I2CMasterInitExpClk(I2C1_BASE, SysCtlClockGet(), false);
+    I2CMasterInitExpClk(I2C1_BASE, i2cClockHz, false);
+    i2cSetSpeed(i2cSpeed);
 
     HWREG(I2C1_BASE + I2C_O_FIFOCTL) = 80008000;
 }
 
+void initI2c()
+{
+    i2cClockHz = SysCtlClockGet();
+    initI2cModule();
+}
+
+uint32_t i2cSetSpeed(uint32_t speedHz)
+{
+    const uint32_t clock = i2cClockHz;
+    
+    if ((speedHz == 0) || (speedHz > I2C_SPEED_FAST))
+    {
+        return 0;
+    }
+    
+    //rounded up so requested rate is never exceeded
+    const uint32_t tpr = ((clock + (20 * speedHz) - 1) / (20 * speedHz)) - 1;
+    if (tpr > 0x7F)
+    {
+        return 0;
+    }
+    
+    HWREG(I2C1_BASE + I2C_O_MTPR) = tpr;
+    i2cSpeed = speedHz;
+    
+    return clock / (20 * (tpr + 1));
+}
+
+int i2cMasterError(bool receiving)
+{
+    uint32_t error = I2CMasterErr(I2C1_BASE);
+    
+    if (error == I2C_MASTER_ERR_NONE)
+    {
+        return 0;
+    }
+    
+    if (error & I2C_MASTER_ERR_ARB_LOST)
+    {
+        //master already released the bus
+        return -ECOMM;
+    }
+    
+    I2CMasterControl(I2C1_BASE, receiving ? I2C_MASTER_CMD_BURST_RECEIVE_ERROR_STOP :
+                                            I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+    
+    return (error & I2C_MASTER_ERR_ADDR_ACK) ? -ENXIO : -EIO;
+}
+
+void i2cBusRecover(void)
+{
+    //half period of 100kHz clock
+    const uint32_t halfPeriod = i2cClockHz / (3 * 200000);
+    
+    //take the pins from i2c module, both open drain and released
+    GPIOPinTypeGPIOOutputOD(GPIO_PORTA_BASE, GPIO_PIN_6 | GPIO_PIN_7);
+    GPIOPinWrite(GPIO_PORTA_BASE, GPIO_PIN_6 | GPIO_PIN_7, GPIO_PIN_6 | GPIO_PIN_7);
+    
+    //up to 9 clocks let the slave finish the byte it's sending and see NACK
+    for (uint8_t i = 0; (i < 9) && !GPIOPinRead(GPIO_PORTA_BASE, GPIO_PIN_7); i++)
+    {
+        GPIOPinWrite(GPIO_PORTA_BASE, GPIO_PIN_6, 0);
+        SysCtlDelay(halfPeriod);
+        GPIOPinWrite(GPIO_PORTA_BASE, GPIO_PIN_6, GPIO_PIN_6);
+        SysCtlDelay(halfPeriod);
+    }
+    
+    //stop condition, SDA rises while SCL is high
+    GPIOPinWrite(GPIO_PORTA_BASE, GPIO_PIN_7, 0);
+    SysCtlDelay(halfPeriod);
+    GPIOPinWrite(GPIO_PORTA_BASE, GPIO_PIN_7, GPIO_PIN_7);
+    SysCtlDelay(halfPeriod);
+    
+    //reset of the module clears its interrupt mask, interrupt engine needs it back
+    const bool intEnabled = (HWREG(I2C1_BASE + I2C_O_MIMR) & I2C_MIMR_IM) != 0;
+    initI2cModule();
+    if (intEnabled)
+    {
+        I2CMasterIntEnable(I2C1_BASE);
+    }
+}
+
+/**
+* @brief wait until i2c master is done, at most I2C_BLOCKING_TIMEOUT_US
+* @param receiving true if master is receiving data
+* @return 0 on success or error code
+*/
+static int i2cWaitDone(bool receiving)
+{
+    //SysCtlDelay takes 3 cycles per loop
+    const uint32_t microsecond = i2cClockHz / 3000000;
+    uint32_t timeout = I2C_BLOCKING_TIMEOUT_US;
+    
+    while(I2CMasterBusy(I2C1_BASE))
+    {
+        if(timeout-- == 0)
+        {
+            i2cBusRecover();
+            return -ETIMEDOUT;
+        }
+        SysCtlDelay(microsecond);
+    }
+    
+    return i2cMasterError(receiving);
+}
+
 int i2cRead(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
 {
-     I2CMasterSlaveAddrSet(I2C1_BASE, slaveAddr, false);  // true -> initiate read from slave, false -> write to slave 
-     I2CMasterDataPut(I2C1_BASE, reg);
-     I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-     while(I2CMasterBusy(I2C1_BASE))
-     {
-     }
-     
-     I2CMasterSlaveAddrSet(I2C1_BASE, slaveAddr, true);
-     I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_START);
-     
-     //wait for MCU to finish transaction
-     while(I2CMasterBusy(I2C1_BASE))
-     {
-     }
-     
-     for(uint16_t i = 0; i < length; i++)
-      {
-          *(data + i) = I2CMasterDataGet(I2C1_BASE);
-          if(i == (length - 1))
-          {
-              I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_FINISH);
-          }
-          else
-          {
-              I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_CONT);
-          }
-          while(I2CMasterBusy(I2C1_BASE))
-          {
-          }  
-      }
-    
-      return 0;
+    I2CMasterSlaveAddrSet(I2C1_BASE, slaveAddr, false);  // true -> initiate read from slave, false -> write to slave 
+    I2CMasterDataPut(I2C1_BASE, reg);
+    I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_SEND_START);
+    
+    //nobody answered on this address, stop right away
+    int status = i2cWaitDone(false);
+    if(status != 0)
+    {
+        return status;
+    }
+    
+    //repeated start
+    return i2cReadCurrent(slaveAddr, data, length);
+}
+
+int i2cReadCurrent(uint8_t slaveAddr, uint8_t *data, uint16_t length)
+{
+    I2CMasterSlaveAddrSet(I2C1_BASE, slaveAddr, true);
+    
+    if (length == 1)
+    {
+        I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_SINGLE_RECEIVE);
+        int status = i2cWaitDone(true);
+        if(status != 0)
+        {
+            return status;
+        }
+        data[0] = I2CMasterDataGet(I2C1_BASE);
+        
+        return 0;
+    }
+    
+    for(uint16_t i = 0; i < length; i++)
+    {
+        if(i == 0)
+        {
+            I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_START);
+        }
+        else if(i == (length - 1))
+        {
+            I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_FINISH);
+        }
+        else
+        {
+            I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_RECEIVE_CONT);
+        }
+        int status = i2cWaitDone(true);
+        if(status != 0)
+        {
+            return status;
+        }
+        data[i] = I2CMasterDataGet(I2C1_BASE);
+    }
+    
+    return 0;
 }
 
 int i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
@@ -138,9 +381,12 @@ int i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
     I2CMasterSlaveAddrSet(I2C1_BASE, slaveAddr, false);
     I2CMasterDataPut(I2C1_BASE, reg);
     I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-    while(I2CMasterBusy(I2C1_BASE))
+    int status = i2cWaitDone(false);
+    if(status != 0)
     {
+        return status;
     }
+    
     for(uint16_t i = 0; i < length; i++)
     {
         I2CMasterDataPut(I2C1_BASE, data[i]);
@@ -152,8 +398,10 @@ int i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
         {
             I2CMasterControl(I2C1_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
         }
-        while(I2CMasterBusy(I2C1_BASE))
+        status = i2cWaitDone(false);
+        if(status != 0)
         {
+            return status;
         }
     }
     return 0;
@@ -23,6 +23,7 @@ extern "C" {
 #include "../driverlib/i2c.h"
 #include "../inc/hw_memmap.h"
 #include "../driverlib/uart.h"
+#include "../driverlib/cpu.h"
 #include "../utils/uartstdio.h"
 
 #include "tm4c123gh6pm.h"
@@ -44,24 +45,141 @@ void enablePeripheralsClock(void);
 */
 void initPorts(void (*portA2IntHandler)(void));
 
+/** @brief port of DRDY pins of multiple devices */
+#define DRDY_PORT_BASE          GPIO_PORTB_BASE
+#define DRDY_PORT_PERIPH        SYSCTL_PERIPH_GPIOB
+
 /**
-* @brief init of timer, generate interrupt every 1 sec
-* @param pfnHandler pointer to a handler function timer interrupt
+* @brief pins of DRDY_PORT_BASE as inputs with pull-up and falling edge interrupt
+* @param pins mask of pins
+* @param portIntHandler pointer to a handler function of port interrupt
 */
-void initTimer1mSec(void (*pfnHandler)(void));
+void initDrdyPort(uint8_t pins, void (*portIntHandler)(void));
 
 /**
-* @brief init of i2c1, speed 100kbs
-* @param slaveAddr address of slave
+* @brief init of Timer0 as free running 32-bit counter of system clock cycles
+*
+* Counter keeps running while core sleeps, it wraps after 107 s at 40 MHz.
+* Its match interrupt is the alarm, see timerSetAlarm().
+* @param pfnHandler pointer to a handler function of match interrupt
+*/
+void initTimestampTimer(void (*pfnHandler)(void));
+
+/**
+* @brief value of Timer0 counter
+*/
+uint32_t timestampCounter(void);
+
+/**
+* @brief frequency of Timer0 counter in Hz
+*/
+uint32_t timestampFrequency(void);
+
+/**
+* @brief enable match interrupt of Timer0 at counter value
+*
+* If counter already passed the value, interrupt is pended at once.
+* @param timestamp counter value, at most half of counter range ahead
+*/
+void timerSetAlarm(uint32_t timestamp);
+
+/**
+* @brief disable match interrupt of Timer0
+*/
+void timerCancelAlarm(void);
+
+/**
+* @brief note that interrupt changed state which main loop may wait for, called by handlers
+*/
+void signalEvent(void);
+
+/**
+* @brief sleep until interrupt, return at once if one was signalled since the last call
+*
+* Flag is tested with interrupts masked, so event which comes after the caller
+* checked its condition isn't lost. Pending interrupt wakes the core while masked.
+*/
+void waitForEvent(void);
+
+/**
+* @brief enable DWT cycle counter of the core, system clock must be set before
+*/
+void initCycleCounter(void);
+
+/**
+* @brief value of DWT cycle counter, it counts system clock cycles and wraps after 107 s at 40 MHz
+*/
+uint32_t cycleCounter(void);
+
+/**
+* @brief convert number of system clock cycles to nanoseconds
+*/
+uint64_t cyclesToNs(uint32_t cycles);
+
+/** @brief standard mode SCL rate */
+#define I2C_SPEED_STANDARD          100000u
+
+/** @brief fast mode SCL rate, the highest one i2c module supports */
+#define I2C_SPEED_FAST              400000u
+
+#ifndef I2C_INIT_SPEED
+/** @brief SCL rate set by initI2c(), can be defined in project options */
+#define I2C_INIT_SPEED              I2C_SPEED_STANDARD
+#endif
+
+/**
+* @brief init of i2c1, speed I2C_INIT_SPEED or the last one set by i2cSetSpeed()
 */
 void initI2c();
 
+/**
+* @brief change SCL rate of i2c1
+*
+* Rate is rounded down to the one timer period register can generate,
+* SCL period is 20 * (TPR + 1) system clock cycles.
+*
+* @param speedHz requested rate, at most I2C_SPEED_FAST
+* @return achieved rate in Hz, 0 if requested rate can't be generated
+* @note must not be called while transaction is in progress
+*/
+uint32_t i2cSetSpeed(uint32_t speedHz);
+
+/**
+* @brief longest wait for one byte of blocking i2c functions
+*
+* Blocking functions have no deadline parameter, so timeoutUs of device
+* is honoured only by transactions started with i2cStart().
+*/
+#define I2C_BLOCKING_TIMEOUT_US     1000
+
+/** @brief deadline of transaction in interrupt mode if it doesn't specify one */
+#define I2C_DEFAULT_TIMEOUT_US      2000
+
+/**
+* @brief read and clear error of i2c master, send stop if needed
+* @param receiving true if master was receiving data
+* @return 0 if there is no error, -ENXIO on address NACK, -EIO on data NACK,
+* -ECOMM if arbitration was lost
+*/
+int i2cMasterError(bool receiving);
+
+/**
+* @brief free the bus held by a slave
+*
+* SCL is clocked until slave releases SDA (at most 9 clocks), then stop
+* condition is generated and i2c1 is initialized again. Takes about 100 us.
+* Master interrupt stays enabled if it was enabled before.
+*/
+void i2cBusRecover(void);
+
 /**
 * @brief i2c write command
 * @param slaveAddr address of slave
 * @param reg address of register you want to write into
 * @param data pointer to a data you want to write into slave
 * @param length length of data you want to send
+* @return 0 on success or error code, see i2cMasterError(), -ETIMEDOUT if bus is stuck
+* for I2C_BLOCKING_TIMEOUT_US in one byte
 */
 int i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length);
 
@@ -71,9 +189,21 @@ int i2cWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length);
 * @param reg address of register you want to read
 * @param data pointer to a data you want to read from
 * @param length length of data you want to receive
+* @return 0 on success or error code, see i2cMasterError(), -ETIMEDOUT if bus is stuck
+* for I2C_BLOCKING_TIMEOUT_US in one byte
 */
 int i2cRead(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length);
 
+/**
+* @brief i2c read command without writing the register address
+* @param slaveAddr address of slave
+* @param data pointer to a data you want to read from
+* @param length length of data you want to receive
+* @return 0 on success or error code, see i2cMasterError(), -ETIMEDOUT if bus is stuck
+* for I2C_BLOCKING_TIMEOUT_US in one byte
+*/
+int i2cReadCurrent(uint8_t slaveAddr, uint8_t *data, uint16_t length);
+
 /**
 * @brief init of uart0 for debugging 
 */
@@ -0,0 +1,549 @@
+/**
+* @file tmp006_sim.c
+* @brief Software model of TMP006 sensors on I2C bus, running on virtual time
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_sim.h"
+#include "../tmp006/tmp006.h"
+#include <errno.h>
+#include <stddef.h>
+#include <math.h>
+
+/** @brief Die temperature after power on, 22 C */
+#define SIM_DEFAULT_TEMPERATURE     (22 * 32)
+
+/** @brief Bits of start condition and of stop condition */
+#define SIM_CONDITION_BITS          1
+
+/** @brief Bits of one byte with its acknowledge */
+#define SIM_BYTE_BITS               9
+
+static TMP006_SimBus *activeBus;
+
+/**
+* @brief next value of noise generator, xorshift32
+*/
+static uint32_t nextRandom(TMP006_Sim *sim)
+{
+    uint32_t x = sim->seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->seed = x;
+
+    return x;
+}
+
+/**
+* @brief value of waveform at given time
+*/
+static int32_t sampleWaveform(TMP006_Sim *sim, const TMP006_SimWaveform *wave, uint64_t now)
+{
+    int32_t value = wave->offset;
+
+    if ((wave->periodMs != 0) && (wave->amplitude != 0))
+    {
+        const double phase = (double)(now % ((uint64_t)wave->periodMs * 1000)) / ((double)wave->periodMs * 1000);
+        value += (int32_t)lround(wave->amplitude * sin(2 * M_PI * phase));
+    }
+
+    if (wave->noise != 0)
+    {
+        value += (int32_t)(nextRandom(sim) % (2u * wave->noise + 1)) - wave->noise;
+    }
+
+    return value;
+}
+
+/**
+* @brief limit value to range
+*/
+static int32_t clamp(int32_t value, int32_t min, int32_t max)
+{
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+/**
+* @brief duration of one conversion for current configuration
+* @return microseconds, TMP006_SIM_NEVER in power down mode
+*/
+static uint64_t conversionTime(const TMP006_Sim *sim)
+{
+    if ((sim->config & TMP006_MOD_MASK) == 0)
+    {
+        return TMP006_SIM_NEVER;
+    }
+
+    //4, 2, 1, 0.5 and 0.25 conversions per second, higher codes are 0.25 as well
+    uint8_t cr = (sim->config & TMP006_CR_MASK) >> 9;
+    if (cr > 4)
+    {
+        cr = 4;
+    }
+
+    return (uint64_t)((int64_t)(250000ull << cr) * (1000000 + sim->clockErrorPpm) / 1000000);
+}
+
+/**
+* @brief start new conversion, result of the running one is lost
+*/
+static void restartConversion(TMP006_Sim *sim, uint64_t now)
+{
+    const uint64_t duration = conversionTime(sim);
+
+    sim->nextConversion = (duration == TMP006_SIM_NEVER) ? TMP006_SIM_NEVER : (now + duration);
+}
+
+/**
+* @brief store result of finished conversion and start the next one
+*/
+static void finishConversion(TMP006_Sim *sim)
+{
+    const uint64_t now = sim->nextConversion;
+
+    sim->voltage = (int16_t)clamp(sampleWaveform(sim, &sim->voltageWave, now), INT16_MIN, INT16_MAX);
+    sim->temperature = (int16_t)clamp(sampleWaveform(sim, &sim->temperatureWave, now), -8192, 8191);
+    sim->conversions++;
+    restartConversion(sim, now);
+
+    //pin is already low if previous result wasn't read
+    const bool edge = !sim->drdy && (sim->config & TMP006_DRDY_EN_MASK);
+    sim->drdy = true;
+
+    if (edge && (sim->drdyHandler != NULL))
+    {
+        sim->drdyHandler(sim, sim->context);
+    }
+}
+
+/**
+* @brief reset values of registers
+*/
+static void resetRegisters(TMP006_Sim *sim)
+{
+    sim->pointer = 0;
+    sim->config = TMP006_CONFIG_DEFAULT;
+    sim->drdy = false;
+}
+
+/**
+* @brief add bus time of transferred bits to virtual time
+*/
+static void addBusTime(TMP006_SimBus *bus, uint32_t bits)
+{
+    bus->busyNs += ((uint64_t)bits * 1000000000ull) / bus->sclHz;
+
+    const uint64_t us = bus->busyNs / 1000;
+    bus->busyNs %= 1000;
+    tmp006_simAdvance(bus, us);
+}
+
+/**
+* @brief find device which acknowledges address
+*/
+static TMP006_Sim *findDevice(TMP006_SimBus *bus, uint8_t addr)
+{
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        if ((bus->devices[i]->address == addr) && bus->devices[i]->present)
+        {
+            return bus->devices[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+* @brief value of register as seen on the bus
+*/
+static uint16_t readRegister(TMP006_Sim *sim)
+{
+    switch (sim->pointer)
+    {
+        case TMP006_VOBJECT:
+            sim->drdy = false;
+            return (uint16_t)sim->voltage;
+        case TMP006_TEMP_AMBIENT:
+            sim->drdy = false;
+            return (uint16_t)(sim->temperature << 2);
+        case TMP006_CONFIG:
+            return sim->config | (sim->drdy ? TMP006_DRDY_RESULT_READY_MASK : 0);
+        case TMP006_MANUFACTURER_ID:
+            return TMP006_MANUF_ID_VALUE;
+        case TMP006_DEVICE_ID:
+            return TMP006_DEVICE_ID_VALUE;
+        default:
+            return 0;
+    }
+}
+
+/**
+* @brief write into register pointer register points to
+*/
+static void writeRegister(TMP006_Sim *sim, uint16_t value, uint64_t now)
+{
+    if (sim->pointer != TMP006_CONFIG)
+    {
+        return;
+    }
+
+    if (value & TMP006_RST_MASK)
+    {
+        resetRegisters(sim);
+        sim->pointer = TMP006_CONFIG;
+    }
+    else
+    {
+        sim->config = value & ~(TMP006_RST_MASK | TMP006_DRDY_RESULT_READY_MASK);
+        sim->drdy = false;
+    }
+
+    restartConversion(sim, now);
+}
+
+void tmp006_simInit(TMP006_Sim *sim, uint8_t address)
+{
+    const TMP006_SimWaveform voltage = { 0 };
+    const TMP006_SimWaveform temperature = { .offset = SIM_DEFAULT_TEMPERATURE };
+
+    sim->address = address;
+    sim->present = true;
+    resetRegisters(sim);
+    sim->voltage = 0;
+    sim->temperature = 0;
+    sim->nextConversion = TMP006_SIM_NEVER;
+    sim->conversions = 0;
+    sim->seed = 0x9E3779B9u ^ address;
+    sim->clockErrorPpm = 0;
+    sim->arbitrationLosses = 0;
+    sim->voltageWave = voltage;
+    sim->temperatureWave = temperature;
+    sim->drdyHandler = NULL;
+    sim->context = NULL;
+}
+
+void tmp006_simBusInit(TMP006_SimBus *bus)
+{
+    bus->deviceCount = 0;
+    bus->now = 0;
+    bus->sclHz = TMP006_I2C_STANDARD_MODE;
+    bus->busyNs = 0;
+    bus->transfers = 0;
+    bus->nextTick = TMP006_SIM_NEVER;
+    bus->tickPeriod = 0;
+    bus->tickHandler = NULL;
+    bus->tickContext = NULL;
+    bus->port = NULL;
+}
+
+int tmp006_simAttach(TMP006_SimBus *bus, TMP006_Sim *sim)
+{
+    if (bus->deviceCount >= TMP006_SIM_MAX_DEVICES)
+    {
+        return -ENOSPC;
+    }
+
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        if (bus->devices[i]->address == sim->address)
+        {
+            return -EEXIST;
+        }
+    }
+
+    bus->devices[bus->deviceCount++] = sim;
+    restartConversion(sim, bus->now);
+
+    return 0;
+}
+
+uint64_t tmp006_simNextEvent(const TMP006_SimBus *bus)
+{
+    uint64_t next = TMP006_SIM_NEVER;
+
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        if (bus->devices[i]->nextConversion < next)
+        {
+            next = bus->devices[i]->nextConversion;
+        }
+    }
+
+    return next;
+}
+
+/**
+* @brief raise interrupt of port if edges came and no other conversion finishes now
+*/
+static void raisePort(TMP006_SimBus *bus)
+{
+    TMP006_SimPort *port = bus->port;
+
+    if ((port == NULL) || (port->status == 0) || (port->handler == NULL))
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        if (bus->devices[i]->nextConversion == bus->now)
+        {
+            return;
+        }
+    }
+
+    port->interrupts++;
+    port->handler(port, port->context);
+}
+
+/**
+* @brief falling edge of DRDY pin connected to port
+*/
+static void portEdge(TMP006_Sim *sim, void *context)
+{
+    TMP006_SimPort *port = context;
+
+    for (uint8_t i = 0; i < port->pinCount; i++)
+    {
+        if (port->pins[i] == sim)
+        {
+            port->status |= (uint8_t)(1 << i);
+        }
+    }
+}
+
+void tmp006_simAdvance(TMP006_SimBus *bus, uint64_t us)
+{
+    const uint64_t target = bus->now + us;
+
+    //conversions and ticks are processed in order of time, handlers see time of their event
+    for (;;)
+    {
+        TMP006_Sim *first = NULL;
+        for (uint8_t i = 0; i < bus->deviceCount; i++)
+        {
+            TMP006_Sim *sim = bus->devices[i];
+            if ((sim->nextConversion <= target) &&
+                ((first == NULL) || (sim->nextConversion < first->nextConversion)))
+            {
+                first = sim;
+            }
+        }
+
+        if ((bus->nextTick <= target) && ((first == NULL) || (bus->nextTick <= first->nextConversion)))
+        {
+            bus->now = bus->nextTick;
+            bus->nextTick = (bus->tickPeriod == 0) ? TMP006_SIM_NEVER : (bus->nextTick + bus->tickPeriod);
+            bus->tickHandler(bus->tickContext);
+        }
+        else if (first != NULL)
+        {
+            bus->now = first->nextConversion;
+            finishConversion(first);
+            raisePort(bus);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    //handler which used the bus, like an interrupt does, moved time by itself
+    if (bus->now < target)
+    {
+        bus->now = target;
+    }
+}
+
+void tmp006_simIdle(TMP006_SimBus *bus, uint64_t maxUs)
+{
+    const uint64_t next = tmp006_simNextEvent(bus);
+
+    //timer tick wakes CPU too, time stops at it
+    if ((bus->nextTick != TMP006_SIM_NEVER) && ((bus->nextTick - bus->now) < maxUs) &&
+        ((next == TMP006_SIM_NEVER) || (bus->nextTick < next)))
+    {
+        tmp006_simAdvance(bus, bus->nextTick - bus->now);
+        return;
+    }
+
+    if ((next != TMP006_SIM_NEVER) && (next <= (bus->now + 1)))
+    {
+        tmp006_simAdvance(bus, next - bus->now);
+    }
+    else if ((next != TMP006_SIM_NEVER) && ((next - 1 - bus->now) < maxUs))
+    {
+        tmp006_simAdvance(bus, next - 1 - bus->now);
+    }
+    else
+    {
+        tmp006_simAdvance(bus, maxUs);
+    }
+}
+
+void tmp006_simSetTimer(TMP006_SimBus *bus, uint32_t periodUs, void (*handler)(void *context), void *context)
+{
+    bus->tickPeriod = periodUs;
+    bus->tickHandler = handler;
+    bus->tickContext = context;
+    bus->nextTick = ((periodUs == 0) || (handler == NULL)) ? TMP006_SIM_NEVER : (bus->now + periodUs);
+}
+
+void tmp006_simSetAlarm(TMP006_SimBus *bus, uint64_t atUs, void (*handler)(void *context), void *context)
+{
+    bus->tickPeriod = 0;
+    bus->tickHandler = handler;
+    bus->tickContext = context;
+    //virtual time doesn't go back for the tick
+    bus->nextTick = (handler == NULL) ? TMP006_SIM_NEVER : ((atUs > bus->now) ? atUs : bus->now);
+}
+
+void tmp006_simPortInit(TMP006_SimPort *port, TMP006_SimBus *bus)
+{
+    port->pinCount = 0;
+    port->status = 0;
+    port->interrupts = 0;
+    port->handler = NULL;
+    port->context = NULL;
+    bus->port = port;
+}
+
+int tmp006_simPortConnect(TMP006_SimPort *port, TMP006_Sim *sim)
+{
+    if (port->pinCount >= TMP006_SIM_MAX_DEVICES)
+    {
+        return -ENOSPC;
+    }
+
+    port->pins[port->pinCount++] = sim;
+    sim->drdyHandler = portEdge;
+    sim->context = port;
+
+    return 0;
+}
+
+uint32_t tmp006_simSetSpeed(TMP006_SimBus *bus, uint32_t speedHz)
+{
+    if ((speedHz == 0) || (speedHz > TMP006_I2C_FAST_MODE))
+    {
+        return 0;
+    }
+
+    bus->sclHz = speedHz;
+
+    return speedHz;
+}
+
+int tmp006_simWrite(TMP006_SimBus *bus, uint8_t addr, const uint8_t *data, uint16_t length)
+{
+    TMP006_Sim *sim = findDevice(bus, addr);
+
+    if (sim == NULL)
+    {
+        addBusTime(bus, SIM_CONDITION_BITS + SIM_BYTE_BITS);
+        return -ENXIO;
+    }
+
+    addBusTime(bus, SIM_CONDITION_BITS + SIM_BYTE_BITS * (1 + length));
+
+    if (length >= 1)
+    {
+        sim->pointer = data[0];
+    }
+
+    //register is written when both bytes are received
+    if (length >= 3)
+    {
+        writeRegister(sim, (uint16_t)((data[1] << 8) | data[2]), bus->now);
+    }
+
+    return 0;
+}
+
+int tmp006_simRead(TMP006_SimBus *bus, uint8_t addr, uint8_t *data, uint16_t length)
+{
+    TMP006_Sim *sim = findDevice(bus, addr);
+
+    if (sim == NULL)
+    {
+        addBusTime(bus, SIM_CONDITION_BITS + SIM_BYTE_BITS);
+        return -ENXIO;
+    }
+
+    //another master wins the bus while address is sent
+    if (sim->arbitrationLosses > 0)
+    {
+        sim->arbitrationLosses--;
+        addBusTime(bus, SIM_CONDITION_BITS + SIM_BYTE_BITS);
+        return TMP006_ERR_ARB_LOST;
+    }
+
+    //value is latched when address is acknowledged
+    addBusTime(bus, SIM_CONDITION_BITS + SIM_BYTE_BITS);
+    const uint16_t value = readRegister(sim);
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        data[i] = (i & 1) ? (uint8_t)value : (uint8_t)(value >> 8);
+    }
+    addBusTime(bus, SIM_BYTE_BITS * length);
+
+    return 0;
+}
+
+void tmp006_simStop(TMP006_SimBus *bus)
+{
+    bus->transfers++;
+    addBusTime(bus, SIM_CONDITION_BITS);
+}
+
+void tmp006_simUse(TMP006_SimBus *bus)
+{
+    activeBus = bus;
+}
+
+int tmp006_simI2cRead(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    int status = tmp006_simWrite(activeBus, addr, &reg, 1);
+
+    //repeated start
+    if (status == 0)
+    {
+        status = tmp006_simRead(activeBus, addr, data, length);
+    }
+    tmp006_simStop(activeBus);
+
+    return status;
+}
+
+int tmp006_simI2cWrite(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    uint8_t buffer[3] = { reg, 0, 0 };
+
+    if (length > 2)
+    {
+        return -EINVAL;
+    }
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        buffer[1 + i] = data[i];
+    }
+
+    int status = tmp006_simWrite(activeBus, addr, buffer, 1 + length);
+    tmp006_simStop(activeBus);
+
+    return status;
+}
+
+int tmp006_simI2cReadCurrent(uint8_t addr, uint8_t *data, uint16_t length)
+{
+    int status = tmp006_simRead(activeBus, addr, data, length);
+    tmp006_simStop(activeBus);
+
+    return status;
+}
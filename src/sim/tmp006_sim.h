@@ -0,0 +1,273 @@
+/**
+* @file tmp006_sim.h
+* @brief Software model of TMP006 sensors on I2C bus, running on virtual time
+*
+* Model emulates register map, conversion timing of every conversion rate,
+* DRDY flag and pin, and produces results from configurable waveforms with noise.
+* Time is virtual: it is advanced by bus traffic (every SCL bit at the set bus
+* speed) and by tmp006_simAdvance(), so seconds of sensor time pass in microseconds.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TMP006_SIM_H
+#define  TMP006_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Most devices on one simulated bus, all TMP006 addresses */
+#define TMP006_SIM_MAX_DEVICES  8
+
+/** @brief Time of event which will never happen */
+#define TMP006_SIM_NEVER        UINT64_MAX
+
+/**
+* @brief Signal fed into result register: offset + amplitude * sin(2 * pi * t / period) + noise
+*/
+typedef struct TMP006_SimWaveform
+{
+    int32_t  offset;    /**< Value in register LSB */
+    int32_t  amplitude; /**< Amplitude of sine in register LSB */
+    uint32_t periodMs;  /**< Period of sine, 0 for constant signal */
+    uint16_t noise;     /**< Uniform noise is added in range [-noise, noise] LSB */
+} TMP006_SimWaveform;
+
+struct TMP006_Sim;
+
+/**
+* @brief Simulated TMP006 device
+*/
+typedef struct TMP006_Sim
+{
+    uint8_t  address;         /**< I2C address */
+    bool     present;         /**< Device acknowledges its address, can be cleared to simulate failure */
+
+    uint8_t  pointer;         /**< Pointer register */
+    uint16_t config;          /**< CONFIG register without DRDY bit */
+    bool     drdy;            /**< Conversion result is ready, DRDY bit and active DRDY pin */
+    int16_t  voltage;         /**< VOBJECT register */
+    int16_t  temperature;     /**< Die temperature, LSB = 1/32 C, TEMP_AMBIENT holds it shifted left by 2 */
+
+    uint64_t nextConversion;  /**< Virtual time when current conversion is finished */
+    uint32_t conversions;     /**< Number of finished conversions */
+    uint32_t seed;            /**< State of noise generator */
+    int32_t  clockErrorPpm;   /**< Error of internal oscillator, positive makes conversions longer */
+    uint32_t arbitrationLosses; /**< Number of next reads in which another master takes the bus */
+
+    TMP006_SimWaveform voltageWave;     /**< Signal of VOBJECT, LSB = 156.25 nV */
+    TMP006_SimWaveform temperatureWave; /**< Signal of die temperature, LSB = 1/32 C */
+
+    void (*drdyHandler)(struct TMP006_Sim *sim, void *context); /**< Optional, called on falling edge of DRDY pin */
+    void *context;                                              /**< User data for drdyHandler */
+} TMP006_Sim;
+
+struct TMP006_SimPort;
+
+/**
+* @brief Simulated GPIO port with DRDY pins of several devices
+*
+* Falling edge latches bit of its pin in interrupt status, like GPIO port does.
+* Interrupt is raised after all conversions which finish at the same virtual
+* time, so edges which come together are seen by one interrupt.
+*/
+typedef struct TMP006_SimPort
+{
+    TMP006_Sim *pins[TMP006_SIM_MAX_DEVICES]; /**< Device connected to each pin */
+    uint8_t     pinCount;                     /**< Number of connected devices */
+    uint8_t     status;                       /**< Latched edges, bit i is pin i, handler clears it */
+    uint32_t    interrupts;                   /**< Number of raised interrupts */
+
+    void (*handler)(struct TMP006_SimPort *port, void *context); /**< Port interrupt, called while status isn't 0 */
+    void *context;                                               /**< User data for handler */
+} TMP006_SimPort;
+
+/**
+* @brief Simulated I2C bus with its virtual clock
+*/
+typedef struct TMP006_SimBus
+{
+    TMP006_Sim *devices[TMP006_SIM_MAX_DEVICES]; /**< Attached devices */
+    uint8_t     deviceCount;                     /**< Number of attached devices */
+    uint64_t    now;                             /**< Virtual time in microseconds */
+    uint32_t    sclHz;                           /**< Bus speed, sets duration of transfers */
+    uint64_t    busyNs;                          /**< Bus time not yet added to now, below 1 us */
+    uint32_t    transfers;                       /**< Number of performed transfers */
+
+    uint64_t    nextTick;                        /**< Virtual time of next timer tick */
+    uint32_t    tickPeriod;                      /**< Period of timer in microseconds, 0 if it's one-shot or stopped */
+    void      (*tickHandler)(void *context);     /**< Called on every timer tick */
+    void       *tickContext;                     /**< User data for tickHandler */
+
+    TMP006_SimPort *port;                        /**< Optional port with DRDY pins of devices */
+} TMP006_SimBus;
+
+/**
+* @brief Initialize simulated device in its power on state.
+*
+* Temperature is 22 C and voltage 0, both without noise.
+*
+* @param sim Pointer to simulated device
+* @param address I2C address, 0x40 - 0x47
+*/
+void tmp006_simInit(TMP006_Sim *sim, uint8_t address);
+
+/**
+* @brief Initialize simulated bus, virtual time starts at 0 and speed is 100 kHz.
+*
+* @param bus Pointer to simulated bus
+*/
+void tmp006_simBusInit(TMP006_SimBus *bus);
+
+/**
+* @brief Attach device to the bus, its first conversion starts now.
+*
+* @param bus Pointer to simulated bus
+* @param sim Pointer to initialized device
+*
+* @returns 0 on success, -ENOSPC if bus is full, -EEXIST if address is taken
+*/
+int tmp006_simAttach(TMP006_SimBus *bus, TMP006_Sim *sim);
+
+/**
+* @brief Advance virtual time, conversions finished meanwhile are processed in order.
+*
+* @param bus Pointer to simulated bus
+* @param us Number of microseconds
+*/
+void tmp006_simAdvance(TMP006_SimBus *bus, uint64_t us);
+
+/**
+* @brief Get time of the next conversion finished on the bus.
+*
+* @param bus Pointer to simulated bus
+*
+* @returns virtual time in microseconds, TMP006_SIM_NEVER if all devices are powered down
+*/
+uint64_t tmp006_simNextEvent(const TMP006_SimBus *bus);
+
+/**
+* @brief Move virtual time while CPU has nothing to do.
+*
+* Time is moved to 1 us before the next conversion, so code waiting for it sees
+* the time just before the event. If next conversion is 1 us away it is finished.
+* Timer tick which comes first is processed and time stops at it.
+*
+* @param bus Pointer to simulated bus
+* @param maxUs The longest step, used when no conversion is running
+*/
+void tmp006_simIdle(TMP006_SimBus *bus, uint64_t maxUs);
+
+/**
+* @brief Start periodic timer on virtual time, it replaces previous one.
+*
+* @param bus Pointer to simulated bus
+* @param periodUs Period in microseconds, 0 stops the timer
+* @param handler Function called on every tick
+* @param context User data for handler
+*/
+void tmp006_simSetTimer(TMP006_SimBus *bus, uint32_t periodUs, void (*handler)(void *context), void *context);
+
+/**
+* @brief Set one-shot timer on virtual time, it replaces previous timer.
+*
+* @param bus Pointer to simulated bus
+* @param atUs Virtual time of the tick, time in the past is the next call of tmp006_simAdvance()
+* @param handler Function called on the tick, NULL stops the timer
+* @param context User data for handler
+*/
+void tmp006_simSetAlarm(TMP006_SimBus *bus, uint64_t atUs, void (*handler)(void *context), void *context);
+
+/**
+* @brief Initialize port without pins and connect it to the bus, whose time raises its interrupts.
+*
+* @param port Pointer to simulated port
+* @param bus Pointer to simulated bus
+*/
+void tmp006_simPortInit(TMP006_SimPort *port, TMP006_SimBus *bus);
+
+/**
+* @brief Connect DRDY pin of device to the next pin of port, it replaces drdyHandler of device.
+*
+* @param port Pointer to simulated port
+* @param sim Pointer to simulated device
+*
+* @returns 0 on success, -ENOSPC if all pins are used
+*/
+int tmp006_simPortConnect(TMP006_SimPort *port, TMP006_Sim *sim);
+
+/**
+* @brief Set bus speed.
+*
+* @param bus Pointer to simulated bus
+* @param speedHz SCL rate, at most 400 kHz
+*
+* @returns speedHz, 0 if it isn't supported
+*/
+uint32_t tmp006_simSetSpeed(TMP006_SimBus *bus, uint32_t speedHz);
+
+/**
+* @brief Perform one write message.
+*
+* First byte sets pointer register, next two bytes are written into the register.
+* Time of start condition, address and data bytes is added to virtual time.
+*
+* @param bus Pointer to simulated bus
+* @param addr Address of device
+* @param data Bytes of message
+* @param length Number of bytes
+*
+* @returns 0 on success, -ENXIO if nobody acknowledged the address
+*/
+int tmp006_simWrite(TMP006_SimBus *bus, uint8_t addr, const uint8_t *data, uint16_t length);
+
+/**
+* @brief Perform one read message from the register pointer register points to.
+*
+* @param bus Pointer to simulated bus
+* @param addr Address of device
+* @param data Buffer for received bytes
+* @param length Number of bytes
+*
+* @returns 0 on success, -ENXIO if nobody acknowledged the address
+*/
+int tmp006_simRead(TMP006_SimBus *bus, uint8_t addr, uint8_t *data, uint16_t length);
+
+/**
+* @brief Add stop condition to virtual time, called after the last message of transfer.
+*
+* @param bus Pointer to simulated bus
+*/
+void tmp006_simStop(TMP006_SimBus *bus);
+
+/**
+* @brief Select bus used by tmp006_simI2cRead(), tmp006_simI2cWrite() and tmp006_simI2cReadCurrent().
+*
+* @param bus Pointer to simulated bus
+*/
+void tmp006_simUse(TMP006_SimBus *bus);
+
+/**
+* @brief i2cRead function of TMP006_Device performed on simulated bus
+*/
+int tmp006_simI2cRead(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length);
+
+/**
+* @brief i2cWrite function of TMP006_Device performed on simulated bus
+*/
+int tmp006_simI2cWrite(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length);
+
+/**
+* @brief i2cReadCurrent function of TMP006_Device performed on simulated bus
+*/
+int tmp006_simI2cReadCurrent(uint8_t addr, uint8_t *data, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TMP006_SIM_H
@@ -6,7 +6,17 @@
 */
 
 #include "tmp006/tmp006.h"
+#include "tmp006/tmp006_tobj.h"
+#include "tmp006/tmp006_bus.h"
+#include "tmp006/tmp006_stats.h"
 #include "test.h"
+#ifdef LINUX_SIMULATOR
+#include "port/linux/linux_sim.h"
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 
 static bool checkTemperatureValue(void)
 {
@@ -73,6 +83,1161 @@ bool test_writeIntoConfig(void)
     return true;
 }
 
+bool test_configShadow(void)
+{
+    tmp006_resetDevice(&senzor);
+    tmp006_configConvRate(&senzor, TMP006_CONVERSION_RATE_2_CONV_PER_SEC);
+    tmp006_drdyPinConfig(&senzor, TMP006_DRDY_PIN_ON);
+    
+    //shadow must match the device
+    TEST_ASSERT(checkConfigReg(0xFFFF & ~TMP006_DRDY_RESULT_READY_MASK, senzor.configShadow));
+    
+    //same value again must not touch the bus
+    uint32_t saved = tmp006_savedTransactions(&senzor);
+    tmp006_configConvRate(&senzor, TMP006_CONVERSION_RATE_2_CONV_PER_SEC);
+    TEST_ASSERT(tmp006_savedTransactions(&senzor) == (saved + 2));
+    
+    //resync must give the same value
+    uint16_t shadow = senzor.configShadow;
+    TEST_ASSERT(tmp006_syncConfig(&senzor) == 0);
+    TEST_ASSERT(senzor.configShadow == shadow);
+    
+    tmp006_resetDevice(&senzor);
+    TEST_ASSERT(senzor.configShadow == TMP006_CONFIG_DEFAULT);
+    
+    return true;
+}
+
+bool test_configure(void)
+{
+    TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = true
+    };
+    
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    TEST_ASSERT(checkConfigReg(TMP006_MOD_MASK | TMP006_CR_MASK | TMP006_DRDY_EN_MASK,
+                               TMP006_CONTINUOUS_CONVERSION | TMP006_CONVERSION_RATE_4_CONV_PER_SEC | TMP006_DRDY_PIN_ON));
+    
+    //default configuration after reset needs no extra write
+    cfg.rate = TMP006_CONVERSION_RATE_1_CONV_PER_SEC;
+    cfg.drdyPin = TMP006_DRDY_PIN_OFF;
+    uint32_t saved = tmp006_savedTransactions(&senzor);
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    TEST_ASSERT(tmp006_savedTransactions(&senzor) == (saved + 1));
+    TEST_ASSERT(checkConfigReg(0xFFFF, TMP006_CONFIG_DEFAULT));
+    
+    return true;
+}
+
+bool test_readSample(void)
+{
+    TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = true
+    };
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    
+    //first conversion is not finished right after reset
+    TMP006_Sample sample;
+    TEST_ASSERT(tmp006_readSample(&senzor, &sample, true) == -EAGAIN);
+    
+    uint32_t msCounterSnap = msCounter;
+    uint32_t cyclesSnap = platform_cycles();
+    while(!resultReadyFlag)
+    {
+        TEST_ASSERT(msCounter < (msCounterSnap + 1000));
+    }
+    resultReadyFlag = 0;
+    
+    TEST_ASSERT(tmp006_readSample(&senzor, &sample, true) == 0);
+    //sample is timestamped with cycle counter, after the wait for it
+    const uint64_t sampleNs = platform_cyclesToNs(sample.timestamp - cyclesSnap);
+    TEST_ASSERT((sampleNs > 0) && (sampleNs < 1100000000ull));
+    
+    const float tempInC = (float)sample.temperature * 0.03125f;
+    TEST_ASSERT((tempInC >= 18) && (tempInC <= 26));
+    
+    return true;
+}
+
+/**
+* @brief Tobj^4 - Tdie^4 of default calibration in double precision, false if sensitivity isn't positive
+*/
+static bool tobjModel(int16_t voltage, int16_t temperature, double *tObj4)
+{
+    const double tDie = (double)temperature / 32.0 + 273.15;
+    const double t = tDie - 298.15;
+    const double s = 6.4e-14 * (1.0 + 1.75e-3 * t - 1.678e-5 * t * t);
+    const double d = (double)voltage * TMP006_VOBJECT_LSB - (-2.94e-5 - 5.7e-7 * t + 4.63e-9 * t * t);
+    
+    *tObj4 = tDie * tDie * tDie * tDie + (d + 13.4 * d * d) / s;
+    
+    return s > 0;
+}
+
+bool test_computeTobj(void)
+{
+    static const TMP006_Calibration cal = TMP006_CALIBRATION_DEFAULT;
+    
+    //voltage, die temperature and object temperature from double precision model
+    static const int16_t points[][3] = {
+        {    0, 800,  936 },
+        { -188, 800,  800 },
+        { 1000, 640, 1447 },
+        { -500, 960,  749 },
+        { 3000, 800, 2593 }
+    };
+    
+    for (uint16_t i = 0; i < (sizeof(points) / sizeof(points[0])); i++)
+    {
+        int16_t tobj;
+        TEST_ASSERT(tmp006_computeTobj(&cal, points[i][0], points[i][1], &tobj) == 0);
+        TEST_ASSERT(tobj == points[i][2]);
+    }
+    
+    //batch calculation gives the same results
+    int16_t voltages[5], temperatures[5], results[5];
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        voltages[i] = points[i][0];
+        temperatures[i] = points[i][1];
+    }
+    TEST_ASSERT(tmp006_computeTobjBatch(&cal, voltages, temperatures, results, 5) == 0);
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        TEST_ASSERT(results[i] == points[i][2]);
+    }
+    
+    //edges of register range, sensitivity crosses zero near Tdie of -172 C
+    static const int16_t edgeVoltages[] = { INT16_MIN, -1, 0, INT16_MAX };
+    int16_t tobj;
+    for (int32_t temperature = -8192; temperature <= 8191;
+         temperature += ((temperature >= -5536) && (temperature < -5472)) ? 1 : 31)
+    {
+        for (uint16_t i = 0; i < (sizeof(edgeVoltages) / sizeof(edgeVoltages[0])); i++)
+        {
+            double tObj4;
+            const bool valid = tobjModel(edgeVoltages[i], (int16_t)temperature, &tObj4);
+            if (tmp006_computeTobj(&cal, edgeVoltages[i], (int16_t)temperature, &tobj) != 0)
+            {
+                continue;
+            }
+            
+            //result is accepted only if the model has one, checked above -200 C
+            TEST_ASSERT(valid && (tObj4 > 0));
+            const double tObj = (double)tobj / 32.0 + 273.15;
+            if (tobj > -6400)
+            {
+                const double errorLsb = (tObj * tObj * tObj * tObj - tObj4) * 8.0 / (tObj * tObj * tObj);
+                TEST_ASSERT((errorLsb > -2.0) && (errorLsb < 2.0));
+            }
+        }
+    }
+    
+    //object temperature is close to die temperature when sensor looks at the room
+    TMP006_Sample sample;
+    TEST_ASSERT(tmp006_readSample(&senzor, &sample, false) == 0);
+    TEST_ASSERT(tmp006_computeTobj(&cal, sample.voltage, sample.temperature, &tobj) == 0);
+    
+    const float tempInC = (float)tobj * 0.03125f;
+    TEST_ASSERT((tempInC >= 10) && (tempInC <= 40));
+    
+    return true;
+}
+
+bool test_tobjTable(void)
+{
+    static int16_t buffer[4096];
+    TMP006_Calibration cal = TMP006_CALIBRATION_DEFAULT;
+    const TMP006_Calibration exactCal = TMP006_CALIBRATION_DEFAULT;
+    TMP006_TobjTable table;
+    
+    TEST_ASSERT(tmp006_buildTobjTable(&cal, &table, buffer, sizeof(buffer)) == 0);
+    TEST_ASSERT(cal.table == &table);
+    TEST_ASSERT((table.tCount * table.vCount) <= 4096);
+    
+    //sweep of the whole table, bound holds with no slack
+    int16_t exact, interpolated;
+    for (int32_t temperature = TMP006_TABLE_TDIE_MIN; temperature <= TMP006_TABLE_TDIE_MAX; temperature += 37)
+    {
+        for (int32_t voltage = INT16_MIN; voltage <= INT16_MAX; voltage += 97)
+        {
+            if ((tmp006_computeTobj(&exactCal, (int16_t)voltage, (int16_t)temperature, &exact) != 0) ||
+                (exact < TMP006_TABLE_TOBJ_MIN) || (exact > TMP006_TABLE_TOBJ_MAX))
+            {
+                continue;
+            }
+            TEST_ASSERT(tmp006_computeTobj(&cal, (int16_t)voltage, (int16_t)temperature, &interpolated) == 0);
+            TEST_ASSERT(abs(exact - interpolated) <= table.errorEstimate);
+        }
+    }
+    
+    //the worst input of 8 kB table, 146 C and -1.8 mV in the middle of a cell
+    TEST_ASSERT(tmp006_computeTobj(&exactCal, -11503, 4671, &exact) == 0);
+    TEST_ASSERT(tmp006_computeTobj(&cal, -11503, 4671, &interpolated) == 0);
+    PRINTF("error %d LSB, bound %u LSB\n", abs(exact - interpolated), table.errorEstimate);
+    TEST_ASSERT(abs(exact - interpolated) <= table.errorEstimate);
+    
+    TEST_ASSERT(tmp006_buildTobjTable(&cal, NULL, NULL, 0) == 0);
+    TEST_ASSERT(cal.table == NULL);
+    
+    return true;
+}
+
+bool test_bus(void)
+{
+    static TMP006_Bus bus;
+    TMP006_Sample samples[TMP006_BUS_MAX_DEVICES];
+    uint8_t index, readyMask;
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &senzor) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_LOW, 1, &index) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_LOW, 1, NULL) == -EEXIST);
+    
+    TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = true
+    };
+    TEST_ASSERT(tmp006_busConfigure(&bus, TMP006_BUS_MAX_DEVICES, &cfg) == 0);
+    
+    TEST_ASSERT(tmp006_busSampleAll(&bus, samples, false, &readyMask) == 0);
+    TEST_ASSERT(readyMask == (1 << index));
+    
+    TEST_ASSERT(tmp006_busSamplePriority(&bus, samples, 1, &readyMask) == 0);
+    TEST_ASSERT(readyMask == (1 << index));
+    
+    const float tempInC = (float)samples[index].temperature * 0.03125f;
+    TEST_ASSERT((tempInC >= 18) && (tempInC <= 26));
+    
+    return true;
+}
+
+/**
+* @brief transport on which every device answers with zeros, bus isn't used
+*/
+static int zeroRead(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    memset(data, 0, length);
+    
+    return 0;
+}
+
+static int zeroWrite(uint8_t slaveAddr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    return 0;
+}
+
+/**
+* @brief read devices of bus by priority and count reads of each device
+*
+* @return the longest run of calls in which device wasn't read, over all devices
+*/
+static uint32_t samplePriorityRuns(TMP006_Bus *bus, uint8_t maxDevices, uint32_t calls, uint32_t *reads)
+{
+    TMP006_Sample samples[TMP006_BUS_MAX_DEVICES];
+    uint32_t lastRead[TMP006_BUS_MAX_DEVICES] = { 0 };
+    uint32_t longestGap = 0;
+    uint8_t readyMask;
+    
+    for (uint32_t call = 1; call <= calls; call++)
+    {
+        if (tmp006_busSamplePriority(bus, samples, maxDevices, &readyMask) != 0)
+        {
+            return UINT32_MAX;
+        }
+        
+        for (uint8_t i = 0; i < bus->deviceCount; i++)
+        {
+            if (readyMask & (1 << i))
+            {
+                reads[i]++;
+                longestGap = ((call - lastRead[i]) > longestGap) ? (call - lastRead[i]) : longestGap;
+                lastRead[i] = call;
+            }
+        }
+    }
+    
+    return longestGap;
+}
+
+bool test_busPriority(void)
+{
+    static TMP006_Bus bus;
+    const TMP006_Device transport = {
+        .i2cRead = zeroRead,
+        .i2cWrite = zeroWrite
+    };
+    const uint8_t weights[4] = { 3, 2, 1, 1 };
+    uint32_t reads[4] = { 0 };
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &transport) == 0);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, (enum TMP006_PinState)i, weights[i], NULL) == 0);
+    }
+    
+    //two reads per call give 6/7, 4/7, 2/7 and 2/7 of calls to devices
+    TEST_ASSERT(samplePriorityRuns(&bus, 2, 7000, reads) <= 4);
+    TEST_ASSERT((reads[0] == 6000) && (reads[1] == 4000) && (reads[2] == 2000) && (reads[3] == 2000));
+    
+    //device with share over one read per call is read always, credits of others stay bounded
+    TEST_ASSERT(tmp006_busInit(&bus, &transport) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_LOW, 10, NULL) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_HIGH, 1, NULL) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_SDA, 1, NULL) == 0);
+    memset(reads, 0, sizeof(reads));
+    
+    TEST_ASSERT(samplePriorityRuns(&bus, 2, 10000, reads) <= 2);
+    TEST_ASSERT((reads[0] == 10000) && (reads[1] == 5000) && (reads[2] == 5000));
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT(abs(bus.devices[i].credit) <= 12);
+    }
+    
+    return true;
+}
+
+/**
+* @brief completion of submitted sweep
+*/
+static void sweepDone(TMP006_Transaction *txns, uint16_t count, void *context)
+{
+    *(volatile bool *)context = true;
+}
+
+bool test_busSweep(void)
+{
+    static TMP006_Bus bus;
+    static TMP006_Transaction txns[TMP006_BUS_SWEEP_LENGTH];
+    TMP006_Sample samples[TMP006_BUS_MAX_DEVICES];
+    uint16_t count;
+    uint8_t readyMask;
+    volatile bool done = false;
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &senzor) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_LOW, 1, NULL) == 0);
+    
+    TEST_ASSERT(tmp006_busPrepareSweep(&bus, txns, &count) == 0);
+    TEST_ASSERT(count == 2);
+    TEST_ASSERT(platform_i2cSubmit(txns, count, sweepDone, (void *)&done) == 0);
+    
+    uint32_t msCounterSnap = msCounter;
+    while (!done)
+    {
+        TEST_ASSERT(msCounter < (msCounterSnap + 100));
+    }
+    
+    TEST_ASSERT(tmp006_busSweepResult(&bus, txns, samples, &readyMask) == 0);
+    TEST_ASSERT(readyMask == 0x01);
+    
+    const float tempInC = (float)samples[0].temperature * 0.03125f;
+    TEST_ASSERT((tempInC >= 18) && (tempInC <= 26));
+    
+    return true;
+}
+
+#ifdef LINUX_SIMULATOR
+/** @brief simulated bus of submit fallback test, adapter of it takes at most 4 messages */
+static TMP006_SimBus limitedSimBus;
+static Linux_I2cBackend limitedSimI2c;
+static uint32_t limitedRejects;
+
+/**
+* @brief transfer of adapter which refuses more than 4 messages, like some SMBus controllers
+*/
+static int limitedTransfer(void *context, struct i2c_msg *msgs, uint32_t count, uint32_t timeoutUs)
+{
+    if (count > 4)
+    {
+        limitedRejects++;
+        return -EOPNOTSUPP;
+    }
+    
+    return limitedSimI2c.transfer(limitedSimI2c.context, msgs, count, timeoutUs);
+}
+
+/**
+* @brief sweeps of four sensors, 0x43 is absent, through adapter with message limit
+*/
+static bool submitFallbackSweeps(const TMP006_Sim *sims)
+{
+    static TMP006_Bus bus;
+    static TMP006_Transaction txns[TMP006_BUS_SWEEP_LENGTH];
+    const enum TMP006_PinState a1[] = {TMP006_PIN_LOW, TMP006_PIN_HIGH, TMP006_PIN_SDA, TMP006_PIN_SCL};
+    TMP006_Sample samples[TMP006_BUS_MAX_DEVICES];
+    uint16_t count;
+    uint8_t readyMask;
+    volatile bool done;
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &senzor) == 0);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, a1[i], 1, NULL) == 0);
+    }
+    
+    //16 messages, then 21 and 10 are refused, 5 fits two transactions of 2 messages
+    uint32_t transfersSnap = linux_i2cTransferCount();
+    done = false;
+    TEST_ASSERT(tmp006_busPrepareSweep(&bus, txns, &count) == 0);
+    TEST_ASSERT(platform_i2cSubmit(txns, count, sweepDone, (void *)&done) == 0);
+    TEST_ASSERT(done);
+    TEST_ASSERT(limitedRejects == 3);
+    //4 transfers of 4 messages, failed one with 0x43 is repeated per transaction
+    TEST_ASSERT((linux_i2cTransferCount() - transfersSnap) == (3 + 4 + 2));
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        TEST_ASSERT(txns[i].status == 0);
+    }
+    TEST_ASSERT((txns[6].status == TMP006_ERR_ADDR_NACK) && (txns[7].status == TMP006_ERR_ADDR_NACK));
+    TEST_ASSERT(tmp006_busSweepResult(&bus, txns, samples, &readyMask) == TMP006_ERR_ADDR_NACK);
+    TEST_ASSERT(readyMask == 0x07);
+    
+    //limit is kept, transfer with Tdie of 0x42 and Vobj of 0x43 fails only for 0x43
+    transfersSnap = linux_i2cTransferCount();
+    done = false;
+    TEST_ASSERT(tmp006_busPrepareSweep(&bus, txns, &count) == 0);
+    TEST_ASSERT(platform_i2cSubmit(&txns[1], (uint16_t)(count - 1), sweepDone, (void *)&done) == 0);
+    TEST_ASSERT(done);
+    TEST_ASSERT(limitedRejects == 3);
+    TEST_ASSERT((linux_i2cTransferCount() - transfersSnap) == (4 + 2));
+    for (uint8_t i = 1; i < 6; i++)
+    {
+        TEST_ASSERT(txns[i].status == 0);
+    }
+    TEST_ASSERT((txns[6].status == TMP006_ERR_ADDR_NACK) && (txns[7].status == TMP006_ERR_ADDR_NACK));
+    TEST_ASSERT(tmp006_transactionValue(&txns[5]) == (uint16_t)(sims[2].temperature << 2));
+    
+    return true;
+}
+
+bool test_submitFallback(void)
+{
+    static TMP006_Sim sims[3];
+    static const Linux_I2cBackend limited = { .transfer = limitedTransfer };
+    
+    //sensors 0x40 - 0x42, nobody answers on 0x43
+    tmp006_simBusInit(&limitedSimBus);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        tmp006_simInit(&sims[i], (uint8_t)(0x40 + i));
+        TEST_ASSERT(tmp006_simAttach(&limitedSimBus, &sims[i]) == 0);
+    }
+    TEST_ASSERT(initSimI2c(&limitedSimI2c, &limitedSimBus) == 0);
+    limitedRejects = 0;
+    
+    //test board is connected again even if sweeps fail
+    linux_setI2cBackend(&limited);
+    const bool success = submitFallbackSweeps(sims);
+    linux_setI2cBackend(NULL);
+    
+    return success;
+}
+#endif
+
+/**
+* @brief sweeps of all devices found on the bus, on simulated board all eight places are fitted
+*/
+static bool sweepBenchmark(void)
+{
+    static TMP006_Bus bus;
+    static TMP006_Transaction txns[TMP006_BUS_SWEEP_LENGTH];
+    TMP006_Sample samples[TMP006_BUS_MAX_DEVICES];
+    const uint32_t sweeps = 100;
+    uint8_t foundMask;
+    uint8_t readyMask;
+    uint16_t count;
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &senzor) == 0);
+    TEST_ASSERT(tmp006_scanBus(&bus, &foundMask) == 0);
+    TEST_ASSERT(bus.deviceCount != 0);
+#ifdef LINUX_SIMULATOR
+    TEST_ASSERT(foundMask == 0xFF);
+#endif
+    
+#ifdef PORT_LINUX
+    uint32_t transfersSnap = linux_i2cTransferCount();
+#endif
+    uint32_t msCounterSnap = msCounter;
+    
+    for (uint32_t i = 0; i < sweeps; i++)
+    {
+        volatile bool done = false;
+        
+        TEST_ASSERT(tmp006_busPrepareSweep(&bus, txns, &count) == 0);
+        TEST_ASSERT(platform_i2cSubmit(txns, count, sweepDone, (void *)&done) == 0);
+        while (!done)
+        {
+            TEST_ASSERT(msCounter < (msCounterSnap + (sweeps * 100)));
+        }
+        TEST_ASSERT(tmp006_busSweepResult(&bus, txns, samples, &readyMask) == 0);
+    }
+    
+    uint32_t elapsedMs = msCounter - msCounterSnap;
+    PRINTF("%u devices: %u us per sweep\n", bus.deviceCount, (elapsedMs * 1000) / sweeps);
+#ifdef PORT_LINUX
+    const uint32_t transfers = linux_i2cTransferCount() - transfersSnap;
+    PRINTF("%u syscalls per %u sweeps\n", transfers, sweeps);
+#endif
+#ifdef LINUX_SIMULATOR
+    //16 messages of a sweep go in one transfer
+    TEST_ASSERT(transfers == sweeps);
+#endif
+    
+    return true;
+}
+
+bool test_sweepBenchmark(void)
+{
+#ifdef LINUX_SIMULATOR
+    TEST_ASSERT(simBoardPopulate(TMP006_BUS_MAX_DEVICES) == 0);
+    const bool success = sweepBenchmark();
+    TEST_ASSERT(simBoardPopulate(1) == 0);
+    
+    return success;
+#else
+    return sweepBenchmark();
+#endif
+}
+
+bool test_scanBus(void)
+{
+    static TMP006_Bus bus;
+    uint8_t foundMask;
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &senzor) == 0);
+    bus.dev.savedTransactions = 3;
+    TEST_ASSERT(tmp006_scanBus(&bus, &foundMask) == 0);
+    
+    //test board has one sensor with ADR0 and ADR1 low
+    TEST_ASSERT(foundMask == 0x01);
+    TEST_ASSERT(bus.deviceCount == 1);
+    TEST_ASSERT(bus.devices[0].i2cAddress == senzor.i2cAddress);
+    
+    //probes don't reset state of the bus, found device points to its ID register
+    TEST_ASSERT(bus.dev.savedTransactions == 3);
+    const TMP006_Device *dev = tmp006_busAcquire(&bus, 0);
+    TEST_ASSERT(dev->pointerRegValid && (dev->pointerReg == TMP006_DEVICE_ID));
+    tmp006_busRelease(&bus, 0);
+    
+    return true;
+}
+
+bool test_busErrors(void)
+{
+    uint16_t value;
+    TMP006_Device absent = senzor;
+    
+    //nobody answers on address 0x47 on test board
+    absent.i2cAddress = 0x47;
+    absent.pointerRegValid = false;
+    TEST_ASSERT(tmp006_read(&absent, TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_ADDR_NACK);
+    
+    //deadline can't be met, bus must be recovered after it
+    senzor.timeoutUs = 1;
+    TEST_ASSERT(tmp006_read(&senzor, TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_TIMEOUT);
+    senzor.timeoutUs = 0;
+    
+    TEST_ASSERT(tmp006_read(&senzor, TMP006_MANUFACTURER_ID, &value) == 0);
+    TEST_ASSERT(value == TMP006_MANUF_ID_VALUE);
+    
+    return true;
+}
+
+/**
+* @brief count register reads done in 200 ms
+*
+* Registers are alternated so every read has its pointer phase.
+*
+* @return number of reads, 0 if any read failed
+*/
+static uint32_t countReads(void)
+{
+    uint16_t value;
+    uint32_t reads = 0;
+    uint32_t msCounterSnap = msCounter;
+    
+    while (msCounter < (msCounterSnap + 200))
+    {
+        uint8_t reg = (reads & 1) ? TMP006_DEVICE_ID : TMP006_MANUFACTURER_ID;
+        if (tmp006_read(&senzor, reg, &value) != 0)
+        {
+            return 0;
+        }
+        reads++;
+    }
+    
+    return reads;
+}
+
+bool test_i2cSpeed(void)
+{
+    uint32_t standardRate;
+    uint32_t fastRate;
+    
+    TEST_ASSERT(tmp006_setI2cSpeed(&senzor, TMP006_I2C_STANDARD_MODE, &standardRate) == 0);
+    TEST_ASSERT(standardRate <= TMP006_I2C_STANDARD_MODE);
+    uint32_t standardReads = countReads();
+    
+    TEST_ASSERT(tmp006_setI2cSpeed(&senzor, TMP006_I2C_FAST_MODE, &fastRate) == 0);
+    TEST_ASSERT(fastRate <= TMP006_I2C_FAST_MODE);
+    uint32_t fastReads = countReads();
+    
+    TEST_ASSERT(tmp006_setI2cSpeed(&senzor, TMP006_I2C_STANDARD_MODE, NULL) == 0);
+    
+    PRINTF("SCL %u Hz: %u reads/s\n", standardRate, standardReads * 5);
+    PRINTF("SCL %u Hz: %u reads/s\n", fastRate, fastReads * 5);
+    
+    //bus time dominates, so fast mode has to be a lot faster
+    TEST_ASSERT(standardReads != 0);
+    TEST_ASSERT(fastReads > (2 * standardReads));
+    
+    return true;
+}
+
+#ifdef TMP006_STATS
+/** @brief statistics read back from printed dump */
+static TMP006_Stats parsedStats;
+
+/**
+* @brief print line of statistics dump and read it back
+*/
+static void printStatsLine(const char *line)
+{
+    PRINTF("%s", line);
+    tmp006_statsParseLine(&parsedStats, line);
+}
+
+bool test_stats(void)
+{
+    uint16_t value;
+    TMP006_Device absent = senzor;
+    
+    tmp006_statsReset();
+    const TMP006_Stats *stats = tmp006_statsGet();
+    
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT(tmp006_read(&senzor, TMP006_MANUFACTURER_ID, &value) == 0);
+    }
+    TEST_ASSERT(stats->call[TMP006_STATS_READ].calls == 3);
+    TEST_ASSERT(stats->call[TMP006_STATS_READ].transactions == 3);
+    TEST_ASSERT(stats->call[TMP006_STATS_READ].errors == 0);
+    TEST_ASSERT(stats->call[TMP006_STATS_READ].maxNs > 0);
+    //pointer phase may be skipped after the first read
+    TEST_ASSERT((stats->bytes >= (3 * 3)) && (stats->bytes <= (3 * 5)));
+    
+    //repeated read of missing device is a retry
+    absent.i2cAddress = 0x47;
+    absent.pointerRegValid = false;
+    TEST_ASSERT(tmp006_read(&absent, TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_ADDR_NACK);
+    TEST_ASSERT(tmp006_read(&absent, TMP006_MANUFACTURER_ID, &value) == TMP006_ERR_ADDR_NACK);
+    TEST_ASSERT(stats->call[TMP006_STATS_READ].errors == 2);
+    TEST_ASSERT(stats->retries == 1);
+    
+    //nested calls are counted in both
+    int16_t temperature;
+    TEST_ASSERT(tmp006_readTemp(&senzor, &temperature) == 0);
+    TEST_ASSERT(stats->call[TMP006_STATS_READ_TEMP].calls == 1);
+    TEST_ASSERT(stats->call[TMP006_STATS_READ].calls == 6);
+    
+    memset(&parsedStats, 0, sizeof(parsedStats));
+    tmp006_statsDump(printStatsLine);
+    TEST_ASSERT(memcmp(&parsedStats, stats, sizeof(parsedStats)) == 0);
+    
+    return true;
+}
+#endif
+
+bool test_sampleRing(void)
+{
+    static const TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = true
+    };
+    TMP006_Sample samples[16];
+    uint32_t received = 0;
+    uint32_t lastTimestamp = 0;
+    
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    TEST_ASSERT(startAcquisition(TMP006_SAMPLER_DRDY, 0) == 0);
+    
+    //consumer prints samples while they are read at DRDY edges
+    uint32_t msCounterSnap = msCounter;
+    while (msCounter < (msCounterSnap + 1100))
+    {
+        const uint32_t count = drainSamples(samples, 4);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            PRINTF("sample %d %d\n", samples[i].voltage, samples[i].temperature);
+            //one conversion every 250 ms
+            TEST_ASSERT((received == 0) ||
+                        (platform_cyclesToNs(samples[i].timestamp - lastTimestamp) > 200000000ull));
+            lastTimestamp = samples[i].timestamp;
+            received++;
+        }
+    }
+    TEST_ASSERT(received >= 4);
+    TEST_ASSERT((sampleRing.dropped == 0) && (sampler.missed == 0));
+    
+    //consumer is late, new samples are dropped and the oldest kept
+    msCounterSnap = msCounter;
+    while (msCounter < (msCounterSnap + 3000))
+    {
+    }
+    stopAcquisition();
+    TEST_ASSERT(tmp006_ringCount(&sampleRing) == 8);
+    TEST_ASSERT(sampleRing.dropped >= 3);
+    TEST_ASSERT(sampleRing.highWater == 8);
+    
+    const uint32_t count = drainSamples(samples, 16);
+    TEST_ASSERT(count == 8);
+    for (uint32_t i = 1; i < count; i++)
+    {
+        TEST_ASSERT(platform_cyclesToNs(samples[i].timestamp - samples[i - 1].timestamp) > 200000000ull);
+    }
+    TEST_ASSERT(tmp006_ringCount(&sampleRing) == 0);
+    
+    return true;
+}
+
+bool test_sampler(enum TMP006_SamplerMode mode)
+{
+    static const uint32_t periodMs[] = { 0, 250, 20 };
+    const TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = (mode == TMP006_SAMPLER_DRDY) ? TMP006_DRDY_PIN_ON : TMP006_DRDY_PIN_OFF,
+        .reset = true
+    };
+    TMP006_Sample samples[8];
+    uint32_t received = 0;
+    uint32_t wakeups = 0;
+    
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    TEST_ASSERT(startAcquisition(mode, periodMs[mode]) == 0);
+    
+    //core sleeps until interrupt, samples are read without the consumer
+    uint32_t msCounterSnap = msCounter;
+    while (msCounter < (msCounterSnap + 2100))
+    {
+        platform_waitForEvent();
+        wakeups++;
+        
+        const uint32_t count = drainSamples(samples, 8);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const float tempInC = (float)samples[i].temperature * 0.03125f;
+            TEST_ASSERT((tempInC >= 18) && (tempInC <= 26));
+        }
+        received += count;
+    }
+    stopAcquisition();
+    
+    PRINTF("%u samples, %u wakeups, %u polls, %u without result, latency %u ns\n", received, wakeups,
+           sampler.polls, sampler.notReady, (uint32_t)platform_cyclesToNs(sampler.maxLatency));
+    
+    //8 conversions in 2 s
+    TEST_ASSERT((received >= 7) && (received <= 9));
+    TEST_ASSERT((sampler.errors == 0) && (sampler.missed == 0) && (sampleRing.dropped == 0));
+    //at most 20 ms poll period and two result reads pass from conversion to data
+    TEST_ASSERT((mode != TMP006_SAMPLER_POLLED) || (sampler.notReady > 0));
+    TEST_ASSERT((mode == TMP006_SAMPLER_TIMER) || (platform_cyclesToNs(sampler.maxLatency) < 25000000ull));
+    
+    return true;
+}
+
+#ifdef LINUX_SIMULATOR
+bool test_arbitrationLoss(void)
+{
+    static TMP006_Bus bus;
+    const TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = true
+    };
+    TMP006_Sample samples[8];
+    uint8_t readyMask;
+    uint32_t received = 0;
+    
+    //lost bus is an error of the sample, not a result which isn't ready
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    simBoardSensor()->arbitrationLosses = 1;
+    TEST_ASSERT(tmp006_readSample(&senzor, &samples[0], false) == TMP006_ERR_ARB_LOST);
+    
+    TEST_ASSERT(tmp006_busInit(&bus, &senzor) == 0);
+    TEST_ASSERT(tmp006_busAdd(&bus, TMP006_PIN_LOW, TMP006_PIN_LOW, 1, NULL) == 0);
+    simBoardSensor()->arbitrationLosses = 1;
+    TEST_ASSERT(tmp006_busSampleAll(&bus, samples, false, &readyMask) == TMP006_ERR_ARB_LOST);
+    TEST_ASSERT(readyMask == 0);
+    TEST_ASSERT(tmp006_busSampleAll(&bus, samples, false, &readyMask) == 0);
+    TEST_ASSERT(readyMask == 0x01);
+    
+    //DRDY stays low after failed read, sampler has to repeat it
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    TEST_ASSERT(startAcquisition(TMP006_SAMPLER_DRDY, 0) == 0);
+    uint32_t msCounterSnap = msCounter;
+    while (msCounter < (msCounterSnap + 300))
+    {
+        platform_waitForEvent();
+        received += drainSamples(samples, 8);
+    }
+    const uint32_t notReadySnap = sampler.notReady;
+    simBoardSensor()->arbitrationLosses = 1;
+    while (msCounter < (msCounterSnap + 2100))
+    {
+        platform_waitForEvent();
+        received += drainSamples(samples, 8);
+    }
+    stopAcquisition();
+    simBoardSensor()->arbitrationLosses = 0;
+    
+    PRINTF("%u samples, %u errors, %u without result\n", received, sampler.errors, sampler.notReady);
+    TEST_ASSERT((received >= 7) && (received <= 9));
+    TEST_ASSERT((sampler.errors == 1) && (sampler.notReady == notReadySnap));
+    
+    return true;
+}
+#endif
+
+bool test_predictivePolling(void)
+{
+    const TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_OFF,
+        .reset = true
+    };
+    TMP006_Sample samples[8];
+    uint32_t received = 0;
+    
+#ifdef LINUX_SIMULATOR
+    //oscillator of this sensor is 0.2 % slow
+    simBoardSensor()->clockErrorPpm = 2000;
+#endif
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    TEST_ASSERT(startAcquisition(TMP006_SAMPLER_PREDICTIVE, tmp006_conversionPeriodMs(cfg.rate)) == 0);
+    
+    //first seconds search and acquire the phase of conversions
+    uint32_t msCounterSnap = msCounter;
+    uint32_t polls = 0;
+    uint32_t tracked = 0;
+    while (msCounter < (msCounterSnap + 10000))
+    {
+        platform_waitForEvent();
+        
+        if ((polls == 0) && (msCounter >= (msCounterSnap + 3000)))
+        {
+            polls = sampler.polls;
+            tracked = sampler.samples;
+        }
+        received += drainSamples(samples, 8);
+    }
+    stopAcquisition();
+    polls = sampler.polls - polls;
+    tracked = sampler.samples - tracked;
+    
+#ifdef LINUX_SIMULATOR
+    simBoardSensor()->clockErrorPpm = 0;
+#endif
+    const uint32_t periodUs = (uint32_t)(((uint64_t)sampler.period * 1000) >> 8);
+    PRINTF("%u samples, %u polls for %u tracked samples, period %u us\n", received, sampler.polls,
+           tracked, periodUs);
+    TEST_ASSERT(tracked > 0);
+    PRINTF("%u.%02u polls per sample\n", polls / tracked, (polls % tracked) * 100 / tracked);
+    
+    //40 conversions in 10 s
+    TEST_ASSERT((received >= 38) && (received <= 41));
+    TEST_ASSERT((sampler.errors == 0) && (sampleRing.dropped == 0));
+    TEST_ASSERT(sampler.phase == TMP006_SAMPLER_TRACK);
+    //one poll per sample, two at probe and when drift makes the end late
+    TEST_ASSERT(polls <= (tracked * 2));
+#ifdef LINUX_SIMULATOR
+    TEST_ASSERT((periodUs > 250200) && (periodUs < 250800));
+#endif
+    
+    return true;
+}
+
+/** @brief alarms of tickless test, their period in timestamp counts and the latest one */
+static volatile uint32_t alarmCount;
+static uint32_t alarmPeriod;
+static uint32_t alarmDue;
+static volatile uint32_t alarmMaxLate;
+
+/**
+* @brief alarm handler, sets the next alarm from due time of this one
+*/
+static void alarmHandler(void)
+{
+    const uint32_t late = platform_timestamp() - alarmDue;
+    
+    alarmMaxLate = (late > alarmMaxLate) ? late : alarmMaxLate;
+    alarmCount++;
+    if (alarmPeriod != 0)
+    {
+        alarmDue += alarmPeriod;
+        platform_scheduleAt(alarmDue, alarmHandler);
+    }
+}
+
+bool test_tickless(void)
+{
+    const uint32_t hz = platform_timestampHz();
+    uint32_t wakeups = 0;
+    
+    //without 1 ms timer nothing wakes the core between alarms
+    TEST_ASSERT(platform_configure1msInterrupt(NULL) == 0);
+    const uint32_t msTicksSnap = msTicks;
+    
+    alarmCount = 0;
+    alarmMaxLate = 0;
+    alarmPeriod = hz / 4;
+    uint32_t start = platform_timestamp();
+    alarmDue = start + alarmPeriod;
+    TEST_ASSERT(platform_scheduleAt(alarmDue, alarmHandler) == 0);
+    while ((alarmCount < 4) && ((platform_timestamp() - start) < (2 * hz)))
+    {
+        platform_waitForEvent();
+        wakeups++;
+    }
+    alarmPeriod = 0;
+    TEST_ASSERT(platform_scheduleAt(0, NULL) == 0);
+    const uint32_t elapsedMs = (uint32_t)(((uint64_t)(platform_timestamp() - start) * 1000) / hz);
+    
+    PRINTF("4 alarms in %u ms, %u wakeups, latest by %u counts of %u Hz\n", elapsedMs, wakeups,
+           alarmMaxLate, hz);
+    TEST_ASSERT(alarmCount == 4);
+    //1 ms timer would wake the core 1000 times
+    TEST_ASSERT(wakeups < 50);
+    TEST_ASSERT((elapsedMs >= 1000) && (elapsedMs < 1100));
+    TEST_ASSERT(alarmMaxLate < (hz / 1000));
+    
+    //alarm which already passed fires at once
+    alarmDue = platform_timestamp() - 1;
+    TEST_ASSERT(platform_scheduleAt(alarmDue, alarmHandler) == 0);
+    start = platform_timestamp();
+    while ((alarmCount < 5) && ((platform_timestamp() - start) < (hz / 10)))
+    {
+        platform_waitForEvent();
+    }
+    TEST_ASSERT(alarmCount == 5);
+    
+    //cancelled alarm doesn't fire
+    TEST_ASSERT(platform_scheduleAt(platform_timestamp() + (hz / 20), alarmHandler) == 0);
+    TEST_ASSERT(platform_scheduleAt(0, NULL) == 0);
+    start = platform_timestamp();
+    while ((platform_timestamp() - start) < (hz / 10))
+    {
+        platform_waitForEvent();
+    }
+    TEST_ASSERT(alarmCount == 5);
+    TEST_ASSERT(msTicks == msTicksSnap);
+    
+    TEST_ASSERT(platform_configure1msInterrupt(timerHandler) == 0);
+    
+    return true;
+}
+
+#ifdef LINUX_SIMULATOR
+/** @brief simulated bus with five sensors whose DRDY pins are on one port, one is missing */
+static TMP006_SimBus demuxSimBus;
+/** @brief bus manager of the four sensors, fed by port interrupt */
+static TMP006_Bus demuxBus;
+/** @brief edges passed by port interrupt and the most in one call */
+static uint32_t demuxEdges;
+static uint8_t demuxMaxEdges;
+
+/**
+* @brief port interrupt, devices are only marked and read outside of it
+*/
+static void demuxDrdy(uint8_t readyMask)
+{
+    const uint8_t edges = (uint8_t)__builtin_popcount(readyMask);
+    
+    demuxEdges += edges;
+    demuxMaxEdges = (edges > demuxMaxEdges) ? edges : demuxMaxEdges;
+    tmp006_busDrdy(&demuxBus, readyMask);
+}
+
+/**
+* @brief samples of four sensors whose DRDY pins are on the port of platform, 0x42 between them is missing
+*/
+static bool demuxSamples(TMP006_Sim *sensors, const TMP006_SimPort *port)
+{
+    const TMP006_Device transport = {
+        .i2cRead = tmp006_simI2cRead,
+        .i2cWrite = tmp006_simI2cWrite,
+        .i2cReadCurrent = tmp006_simI2cReadCurrent
+    };
+    const TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = true
+    };
+    TMP006_Sample samples[4];
+    uint32_t received[4] = { 0 };
+    uint8_t foundMask;
+    
+    //pin i is connected to device at 0x40 + i, scan gives index 2 to the one at 0x43
+    TEST_ASSERT(platform_configureDrdyPins(5, demuxDrdy) == 0);
+    TEST_ASSERT(tmp006_busInit(&demuxBus, &transport) == 0);
+    TEST_ASSERT(tmp006_scanBus(&demuxBus, &foundMask) == 0);
+    TEST_ASSERT(foundMask == 0x1B);
+    TEST_ASSERT(demuxBus.deviceCount == 4);
+    TEST_ASSERT(tmp006_busConfigure(&demuxBus, TMP006_BUS_MAX_DEVICES, &cfg) == 0);
+    
+    //conversions end together, later the oscillator of the last sensor makes it 5 % slower
+    for (uint8_t i = 1; i < 5; i++)
+    {
+        sensors[i].nextConversion = sensors[0].nextConversion;
+    }
+    sensors[4].clockErrorPpm = 50000;
+    demuxEdges = 0;
+    demuxMaxEdges = 0;
+    
+    for (uint32_t ms = 0; ms < 2000; ms++)
+    {
+        uint8_t readyMask;
+        tmp006_simAdvance(&demuxSimBus, 1000);
+        TEST_ASSERT(tmp006_busSamplePending(&demuxBus, samples, &readyMask) == 0);
+        
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            if (readyMask & (1 << i))
+            {
+                const float tempInC = (float)samples[i].temperature * 0.03125f;
+                TEST_ASSERT((tempInC >= 18) && (tempInC <= 26));
+                received[i]++;
+            }
+        }
+    }
+    
+    PRINTF("%u edges in %u interrupts, at most %u at once, samples %u %u %u %u\n", demuxEdges, port->interrupts,
+           demuxMaxEdges, received[0], received[1], received[2], received[3]);
+    
+    //8 conversions of each sensor in 2 s, every edge gives one sample
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT((received[i] >= 7) && (received[i] <= 9));
+    }
+    TEST_ASSERT(demuxEdges == (received[0] + received[1] + received[2] + received[3]));
+    TEST_ASSERT(demuxMaxEdges == 4);
+    TEST_ASSERT(port->interrupts < demuxEdges);
+    
+    return true;
+}
+
+bool test_drdyDemux(void)
+{
+    static TMP006_Sim sensors[5];
+    static TMP006_SimPort port;
+    static Linux_GpioBackend gpioPort;
+    
+    tmp006_simBusInit(&demuxSimBus);
+    tmp006_simPortInit(&port, &demuxSimBus);
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        tmp006_simInit(&sensors[i], (uint8_t)(0x40 + i));
+        TEST_ASSERT(tmp006_simAttach(&demuxSimBus, &sensors[i]) == 0);
+        TEST_ASSERT(tmp006_simPortConnect(&port, &sensors[i]) == 0);
+    }
+    sensors[2].present = false;
+    TEST_ASSERT(initSimGpioPort(&gpioPort, &port) == 0);
+    
+    //platform gets the port of the four sensors, test board is connected again after them
+    tmp006_simUse(&demuxSimBus);
+    linux_setGpioBackend(&gpioPort);
+    const bool success = demuxSamples(sensors, &port);
+    linux_setGpioBackend(NULL);
+    
+    return success;
+}
+#endif
+
+bool test_callLatency(void)
+{
+    static const TMP006_Config cfg = {
+        .mode = TMP006_CONTINUOUS_CONVERSION,
+        .rate = TMP006_CONVERSION_RATE_4_CONV_PER_SEC,
+        .drdyPin = TMP006_DRDY_PIN_ON,
+        .reset = false
+    };
+    const uint32_t calls = 100;
+    uint16_t value;
+    uint64_t readNs = 0;
+    uint64_t minReadNs = UINT64_MAX;
+    uint64_t configureNs = 0;
+    
+    TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+    
+    for (uint32_t i = 0; i < calls; i++)
+    {
+        uint32_t start = platform_cycles();
+        TEST_ASSERT(tmp006_read(&senzor, TMP006_MANUFACTURER_ID, &value) == 0);
+        const uint64_t ns = platform_cyclesToNs(platform_cycles() - start);
+        readNs += ns;
+        minReadNs = (ns < minReadNs) ? ns : minReadNs;
+        
+        //CONFIG shadow already holds the value, so the call doesn't touch the bus
+        start = platform_cycles();
+        TEST_ASSERT(tmp006_configure(&senzor, &cfg) == 0);
+        configureNs += platform_cyclesToNs(platform_cycles() - start);
+    }
+    
+    PRINTF("register read: %u ns, min %u ns\n", (uint32_t)(readNs / calls), (uint32_t)minReadNs);
+    PRINTF("configure without bus access: %u ns\n", (uint32_t)(configureNs / calls));
+    
+    //read has at least 3 bytes on the bus, 270 us at 100 kHz
+    TEST_ASSERT(minReadNs > 200000);
+    TEST_ASSERT((configureNs / calls) < 100000);
+    
+    return true;
+}
+
+/**
+* @brief completion callback of asynchronous sample read
+*/
+static void sampleDone(TMP006_SampleRequest *req)
+{
+    *(volatile bool *)req->context = true;
+}
+
+bool test_readAsync(void)
+{
+    TMP006_Transaction txn;
+    TEST_ASSERT(tmp006_readAsync(&senzor, TMP006_MANUFACTURER_ID, &txn, NULL, NULL) == 0);
+    TEST_ASSERT(tmp006_wait(&txn) == 0);
+    TEST_ASSERT(tmp006_transactionValue(&txn) == TMP006_MANUF_ID_VALUE);
+    
+    TMP006_SampleRequest req;
+    TMP006_Sample sample;
+    volatile bool done = false;
+    TEST_ASSERT(tmp006_readSampleAsync(&senzor, &sample, false, &req, sampleDone, (void *)&done) == 0);
+    
+    uint32_t msCounterSnap = msCounter;
+    while (!done)
+    {
+        TEST_ASSERT(msCounter < (msCounterSnap + 100));
+    }
+    TEST_ASSERT(req.status == 0);
+    
+    const float tempInC = (float)sample.temperature * 0.03125f;
+    TEST_ASSERT((tempInC >= 18) && (tempInC <= 26));
+    
+    return true;
+}
+
 /**
 * @brief calculation of mulitple factor
 * Multiple factor is used for calculation of time needed to get all results.
@@ -207,6 +1372,47 @@ void test_run(void)
     
     RUN_TEST("Writing into config register", test_writeIntoConfig);
     
+    RUN_TEST("CONFIG register shadow", test_configShadow);
+    
+    RUN_TEST("Configure device with one call", test_configure);
+    
+    RUN_TEST("Read voltage and temperature sample", test_readSample);
+    
+    RUN_TEST("Asynchronous register and sample read", test_readAsync);
+    
+    RUN_TEST("Calculate object temperature", test_computeTobj);
+    
+    RUN_TEST("Object temperature from lookup table", test_tobjTable);
+    
+    RUN_TEST("Sample devices through bus manager", test_bus);
+    
+    RUN_TEST("Share reads of devices by weight", test_busPriority);
+    RUN_TEST("Sweep of all devices in one submission", test_busSweep);
+#ifdef LINUX_SIMULATOR
+    RUN_TEST("Split submission for adapter with message limit", test_submitFallback);
+#endif
+    
+    RUN_TEST("Scan bus for devices", test_scanBus);
+    RUN_TEST("Check bus error reporting and recovery", test_busErrors);
+    RUN_TEST("Measure sweep latency of all devices on the bus", test_sweepBenchmark);
+    RUN_TEST("Measure register reads per second in standard and fast mode", test_i2cSpeed);
+    RUN_TEST("Measure driver call latency with cycle counter", test_callLatency);
+    RUN_TEST("Read samples at DRDY edge into ring", test_sampleRing);
+    RUN_TEST("Sampler triggered by DRDY pin", test_sampler, TMP006_SAMPLER_DRDY);
+    RUN_TEST("Sampler scheduled by timer", test_sampler, TMP006_SAMPLER_TIMER);
+    RUN_TEST("Sampler polling DRDY bit", test_sampler, TMP006_SAMPLER_POLLED);
+#ifdef LINUX_SIMULATOR
+    RUN_TEST("Sampler keeps reading after lost arbitration", test_arbitrationLoss);
+#endif
+    RUN_TEST("Sampler polling around predicted end of conversion", test_predictivePolling);
+    RUN_TEST("Wake only at alarms without 1 ms timer", test_tickless);
+#ifdef LINUX_SIMULATOR
+    RUN_TEST("Read devices whose DRDY fell on one port interrupt", test_drdyDemux);
+#endif
+#ifdef TMP006_STATS
+    RUN_TEST("Count driver calls and bus traffic", test_stats);
+#endif
+    
     //test conversion rate with interrupt enabled
     RUN_TEST("Check 1 conversion per second rate with interrupt enabled (wait)", test_customConvRateIntOn, TMP006_CONVERSION_RATE_1_CONV_PER_SEC);
     RUN_TEST("Check 2 conversion per second rate with interrupt enabled (wait)", test_customConvRateIntOn, TMP006_CONVERSION_RATE_2_CONV_PER_SEC);
@@ -15,6 +15,8 @@ extern "C" {
 
 #include <stdint.h>
 #include "tmp006/tmp006.h"
+#include "tmp006/tmp006_ring.h"
+#include "tmp006/tmp006_sampler.h"
 #include "platform.h"
 
 
@@ -48,13 +50,25 @@ extern "C" {
 
 
 /** @brief counter of miliseconds, incremented in timer handler*/    
-extern volatile uint32_t msCounter; 
+extern volatile uint32_t msTicks; 
+
+/**
+* @brief milliseconds since setUp(), tests read time only through it
+*
+* Reading it tells time source that test waits, so simulated platform can
+* skip to the next event instead of spinning through virtual time.
+*/
+#define msCounter   (testTime())
 /** @brief counter of received results */    
 extern volatile uint32_t resultCounter;
 /** @brief when set calculation can be performed*/
 extern volatile uint8_t resultReadyFlag;
 
 extern TMP006_Device senzor;
+/** @brief samples read by sampler, see startAcquisition() */
+extern TMP006_SampleRing sampleRing;
+/** @brief sampler of senzor, driven by pin and timer interrupt handlers */
+extern TMP006_Sampler sampler;
 
 
 /**
@@ -94,15 +108,49 @@ bool checkConfigReg(uint16_t mask, uint16_t checkValue);
 
 /**
 * @brief handler for edge interrupt on pin.
-* Announce that result is ready via resultReadyFlag and counts the results.
+* Announce that result is ready via resultReadyFlag and counts the results,
+* and passes the edge to sampler.
 */   
 void pinInterruptHandler(void);
 
 /**
-* @brief handler for timer, 1 ms timer
+* @brief start sampler of senzor with empty sampleRing
+*
+* Sample read is started from pin or timer interrupt and pushed into ring from
+* its completion, so the consumer only drains the ring.
+*
+* @param mode source of reads
+* @param periodMs time between reads in timer and polled mode
+* @return 0 on success or error code
+*/
+int startAcquisition(enum TMP006_SamplerMode mode, uint32_t periodMs);
+
+/**
+* @brief stop sampler, waits for the read in progress
+*/
+void stopAcquisition(void);
+
+/**
+* @brief consumer side of sampleRing, failed read of sampler is repeated first
+*
+* @param samples array for samples
+* @param maxCount size of array
+* @return number of samples copied out of ring
+*/
+uint32_t drainSamples(TMP006_Sample *samples, uint32_t maxCount);
+
+/**
+* @brief handler for timer, 1 ms timer, passes the tick to sampler
 */
 void timerHandler(void);
 
+/**
+* @brief current time of tests in milliseconds, see msCounter
+*
+* @return value of msTicks after platform_idle()
+*/
+uint32_t testTime(void);
+
 /**
 * @brief reading manufacturer id from device
 *
@@ -117,6 +165,169 @@ bool test_readManufId(void);
 */
 bool test_writeIntoConfig(void);
 
+/**
+* @brief test that cached CONFIG register follows the device
+*
+* @return true if test success or false if not
+*/
+bool test_configShadow(void);
+
+/**
+* @brief test of bulk configuration of the device
+*
+* @return true if test success or false if not
+*/
+bool test_configure(void);
+
+/**
+* @brief test of reading voltage and temperature in one call
+*
+* @return true if test success or false if not
+*/
+bool test_readSample(void);
+/**
+* @brief test of asynchronous API
+*
+* @return true if test success or false if not
+*/
+bool test_readAsync(void);
+
+
+/**
+* @brief test of fixed point object temperature calculation
+*
+* @return true if test success or false if not
+*/
+bool test_computeTobj(void);
+
+/**
+* @brief test of object temperature lookup table
+*
+* @return true if test success or false if not
+*/
+bool test_tobjTable(void);
+
+/**
+* @brief test of multi-sensor bus manager
+*
+* @return true if test success or false if not
+*/
+bool test_bus(void);
+
+/**
+* @brief test of reads chosen by priority over thousands of calls
+*
+* @return true if test success or false if not
+*/
+bool test_busPriority(void);
+
+/**
+* @brief test of bus sweep submitted as one queue of transactions
+*
+* @return true if test success or false if not
+*/
+bool test_busSweep(void);
+
+#ifdef LINUX_SIMULATOR
+/**
+* @brief test of submission split for adapter which refuses long transfers, with absent device
+*
+* @return true if test success or false if not
+*/
+bool test_submitFallback(void);
+#endif
+
+/**
+* @brief benchmark of bus sweep latency, on linux also number of syscalls
+*
+* @return true if test success or false if not
+*/
+bool test_sweepBenchmark(void);
+
+/**
+* @brief test of device discovery
+*
+* @return true if test success or false if not
+*/
+bool test_scanBus(void);
+
+/**
+* @brief test of address NACK and deadline errors, bus has to work after them
+*
+* @return true if test success or false if not
+*/
+bool test_busErrors(void);
+
+/**
+* @brief benchmark of register reads per second in standard and fast mode
+*
+* @return true if test success or false if not
+*/
+bool test_i2cSpeed(void);
+
+/**
+* @brief test of samples read at DRDY edge through ring, and of ring overflow
+*
+* @return true if test success or false if not
+*/
+bool test_sampleRing(void);
+
+/**
+* @brief test of sampler in DRDY, timer or polled mode, consumer sleeps between samples
+*
+* @param mode source of reads
+* @return true if test success or false if not
+*/
+bool test_sampler(enum TMP006_SamplerMode mode);
+
+#ifdef LINUX_SIMULATOR
+/**
+* @brief test of lost arbitration in sample reads of driver, bus manager and DRDY sampler
+*
+* @return true if test success or false if not
+*/
+bool test_arbitrationLoss(void);
+#endif
+
+/**
+* @brief test of sampler in predictive mode, prints polls per sample and learned period
+*
+* @return true if test success or false if not
+*/
+bool test_predictivePolling(void);
+
+/**
+* @brief test of one-shot alarm with 1 ms timer stopped
+*
+* @return true if test success or false if not
+*/
+bool test_tickless(void);
+
+#ifdef LINUX_SIMULATOR
+/**
+* @brief test of DRDY pins of four simulated sensors on one port, with a missing address and edges which come together
+*
+* @return true if test success or false if not
+*/
+bool test_drdyDemux(void);
+#endif
+
+/**
+* @brief benchmark of driver call latency measured with cycle counter
+*
+* @return true if test success or false if not
+*/
+bool test_callLatency(void);
+
+#ifdef TMP006_STATS
+/**
+* @brief test of call and bus statistics, dump of them is printed and read back
+*
+* @return true if test success or false if not
+*/
+bool test_stats(void);
+#endif
+
 
 /**
 * @brief test of different conversion rate with disabled interrupt pin
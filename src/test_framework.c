@@ -7,18 +7,33 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "test.h"
+#include "tmp006/tmp006_stats.h"
 
 /** @brief counter of miliseconds, incremented in timer handler*/    
-volatile uint32_t msCounter = 0; 
+volatile uint32_t msTicks = 0; 
 /** @brief counter of received results */    
 volatile uint32_t resultCounter = 0;
 /** @brief when set calculation can be performed*/
 volatile uint8_t resultReadyFlag = 0;
+/** @brief samples read by sampler while acquisition is on */
+TMP006_SampleRing sampleRing;
+/** @brief sampler of senzor, driven by pin and timer interrupt handlers */
+TMP006_Sampler sampler;
+
+/** @brief number of samples in sampleRing, power of two */
+#define SAMPLE_RING_CAPACITY    8
+
+static TMP006_Sample sampleStorage[SAMPLE_RING_CAPACITY];
 
 TMP006_Device senzor = {
         .i2cRead = platform_i2cRead,
-        .i2cWrite = platform_i2cWrite   
+        .i2cWrite = platform_i2cWrite,
+        .i2cReadCurrent = platform_i2cReadCurrent,
+        .i2cStart = platform_i2cStart,
+        .i2cSetSpeed = platform_i2cSetSpeed,
+        .getTime = platform_cycles
     };
    
     
@@ -26,16 +41,54 @@ void pinInterruptHandler(void)
 {
     resultCounter++ ;
     resultReadyFlag = 1;
+    
+    tmp006_samplerDrdy(&sampler);
+}
+
+int startAcquisition(enum TMP006_SamplerMode mode, uint32_t periodMs)
+{
+    int status = tmp006_ringInit(&sampleRing, sampleStorage, SAMPLE_RING_CAPACITY);
+    if (status == 0)
+    {
+        status = tmp006_samplerInit(&sampler, &senzor, mode, periodMs, &sampleRing, NULL, NULL);
+    }
+    if (status == 0)
+    {
+        status = tmp006_samplerStart(&sampler);
+    }
+    
+    return status;
+}
+
+void stopAcquisition(void)
+{
+    tmp006_samplerStop(&sampler);
+}
+
+uint32_t drainSamples(TMP006_Sample *samples, uint32_t maxCount)
+{
+    tmp006_samplerService(&sampler);
+    
+    return tmp006_ringDrain(&sampleRing, samples, maxCount);
 }
 
 void timerHandler(void)
 {
-    msCounter++ ;
+    msTicks++ ;
+    
+    tmp006_samplerTick(&sampler);
+}
+
+uint32_t testTime(void)
+{
+    platform_idle();
+    
+    return msTicks;
 }    
     
 void setUp(void)
 {
-    msCounter = 0;
+    msTicks = 0;
     resultCounter = 0;
     resultReadyFlag = 0;
 }
@@ -64,4 +117,6 @@ void test_init(void)
     platform_configure1msInterrupt(timerHandler);
 
     platform_configureInterruptPin(pinInterruptHandler);
+    
+    tmp006_statsSetClock(platform_cycles, platform_cyclesToNs);
 }
\ No newline at end of file
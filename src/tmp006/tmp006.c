@@ -6,6 +6,7 @@
 */
 
 #include "tmp006.h"
+#include "tmp006_stats.h"
 
 #include <errno.h>
 #include <stddef.h>
@@ -112,6 +113,62 @@ static int setI2cAddress(uint8_t *address ,enum TMP006_PinState A0state, enum TM
 }
 
 
+/**
+* @brief Track value of device pointer register after a transaction
+*
+* If transaction failed it is unknown where the pointer points to.
+*/
+static void updatePointerReg(TMP006_Device *dev, uint8_t reg, int status)
+{
+    dev->pointerReg = reg;
+    dev->pointerRegValid = (status == 0);
+}
+
+/**
+* @brief Keep CONFIG shadow coherent with value that was written to or read from device
+*/
+static void updateConfigShadow(TMP006_Device *dev, uint16_t value)
+{
+    if (value & TMP006_RST_MASK)
+    {
+        //RST bit is self-clearing, all bits go back to default
+        dev->configShadow = TMP006_CONFIG_DEFAULT;
+    }
+    else
+    {
+        dev->configShadow = value & (uint16_t)(~TMP006_DRDY_RESULT_READY_MASK);
+    }
+    dev->configShadowValid = true;
+}
+
+/**
+* @brief Change bits of CONFIG register selected by mask
+*
+* Uses the CONFIG shadow, so only one write is needed and the write is skipped
+* if register already holds the required value.
+*/
+static int updateConfig(TMP006_Device *dev, uint16_t mask, uint16_t value)
+{
+    if (dev->configShadowValid)
+    {
+        dev->savedTransactions++; //read of CONFIG was not needed
+    }
+    else
+    {
+        int status = tmp006_syncConfig(dev);
+        TMP006_FAIL_UNLESS_OK(status);
+    }
+    
+    uint16_t newValue = (uint16_t)((dev->configShadow & ~mask) | value);
+    if (newValue == dev->configShadow)
+    {
+        dev->savedTransactions++; //write of CONFIG was not needed
+        return 0;
+    }
+    
+    return tmp006_write(dev, TMP006_CONFIG, &newValue);
+}
+
 int tmp006_init(TMP006_Device *dev,enum TMP006_PinState A0State, enum TMP006_PinState A1State)
 {
     TMP006_CHECK_PARAM((dev == NULL) || (dev->i2cRead == NULL) || (dev->i2cWrite == NULL));
@@ -119,72 +176,202 @@ int tmp006_init(TMP006_Device *dev,enum TMP006_PinState A0State, enum TMP006_Pin
     int status = setI2cAddress(&dev->i2cAddress, A0State, A1State);
     TMP006_FAIL_UNLESS_OK(status);
     
+    //state of device is unknown until first read or reset
+    dev->configShadow = 0;
+    dev->configShadowValid = false;
+    dev->savedTransactions = 0;
+    dev->pointerRegValid = false;
+    
     return 0;
 }
 
-int tmp006_read(TMP006_Device *dev, uint8_t reg, uint16_t *data)
+void tmp006_complete(TMP006_Transaction *txn, int status)
 {
-    uint8_t value[2];
-    TMP006_CHECK_PARAM((dev == NULL) || (data == NULL));
- 
-    int status = dev->i2cRead(dev->i2cAddress, reg, value, 2);
-    TMP006_FAIL_UNLESS_OK(status);
+    TMP006_Device *dev = txn->dev;
     
-    *data = (uint16_t)(((uint16_t)value[0] << 8) | value[1]); //MSB is received first
-    return 0;
+    TMP006_STATS_TRANSACTION(txn, status);
+    updatePointerReg(dev, txn->reg, status);
+    
+    if ((status == 0) && (txn->type == TMP006_TXN_WRITE) && (txn->reg == TMP006_CONFIG))
+    {
+        const uint16_t value = tmp006_transactionValue(txn);
+        updateConfigShadow(dev, value);
+        
+        if (value & TMP006_RST_MASK)
+        {
+            //after reset the value of pointer register is not guaranteed
+            dev->pointerRegValid = false;
+        }
+    }
+    
+    //status is set last, so the transaction can be reused from callback
+    txn->status = status;
+    if (txn->callback != NULL)
+    {
+        txn->callback(txn);
+    }
 }
 
-int tmp006_write(TMP006_Device *dev, uint8_t reg, uint16_t *data)
+/**
+* @brief Pass transaction to transport
+*
+* Without i2cStart() in device structure, transaction is performed with blocking functions.
+*/
+static void startTransaction(TMP006_Device *dev, TMP006_Transaction *txn)
 {
-    uint8_t value[2];
-    TMP006_CHECK_PARAM((dev == NULL) || (data == NULL));
+    txn->dev = dev;
+    txn->addr = dev->i2cAddress;
+    txn->timeoutUs = dev->timeoutUs;
+    txn->status = TMP006_TXN_PENDING;
+    
+    if ((txn->type == TMP006_TXN_READ) && dev->pointerRegValid && (dev->pointerReg == txn->reg) &&
+        ((dev->i2cStart != NULL) || (dev->i2cReadCurrent != NULL)))
+    {
+        //device still points to the required register
+        txn->type = TMP006_TXN_READ_CURRENT;
+    }
+    
+    int status;
+    if (dev->i2cStart != NULL)
+    {
+        status = dev->i2cStart(txn);
+        if (status == 0)
+        {
+            return;
+        }
+    }
+    else if (txn->type == TMP006_TXN_READ_CURRENT)
+    {
+        status = dev->i2cReadCurrent(txn->addr, txn->data, 2);
+    }
+    else if (txn->type == TMP006_TXN_READ)
+    {
+        status = dev->i2cRead(txn->addr, txn->reg, txn->data, 2);
+    }
+    else
+    {
+        status = dev->i2cWrite(txn->addr, txn->reg, txn->data, 2);
+    }
+    
+    tmp006_complete(txn, status);
+}
 
+int tmp006_readAsync(TMP006_Device *dev, uint8_t reg, TMP006_Transaction *txn,
+                     void (*callback)(TMP006_Transaction *txn), void *context)
+{
+    TMP006_CHECK_PARAM((dev == NULL) || (txn == NULL));
     
-    value[0] = (uint8_t)(*data >> 8);
-    value[1] = (uint8_t)(*data & 0x00FF);
+    txn->reg = reg;
+    txn->type = TMP006_TXN_READ;
+    txn->callback = callback;
+    txn->context = context;
+    startTransaction(dev, txn);
     
-    int status = dev->i2cWrite(dev->i2cAddress, reg, value, 2);
-    TMP006_FAIL_UNLESS_OK(status);
+    return 0;
+}
+
+int tmp006_prepareRead(TMP006_Device *dev, uint8_t reg, TMP006_Transaction *txn)
+{
+    TMP006_CHECK_PARAM((dev == NULL) || (txn == NULL));
+    
+    txn->dev = dev;
+    txn->addr = dev->i2cAddress;
+    txn->timeoutUs = dev->timeoutUs;
+    txn->reg = reg;
+    txn->type = TMP006_TXN_READ;
+    txn->status = TMP006_TXN_PENDING;
+    txn->callback = NULL;
+    txn->context = NULL;
     
     return 0;
 }
 
-int tmp006_configConvRate(TMP006_Device *dev, enum TMP006_ConversionRate rate)
+int tmp006_writeAsync(TMP006_Device *dev, uint8_t reg, uint16_t value, TMP006_Transaction *txn,
+                      void (*callback)(TMP006_Transaction *txn), void *context)
 {
-    TMP006_CHECK_PARAM((dev == NULL) || (rate > TMP006_CONVERSION_RATE_0_25_CONV_PER_SEC));
+    TMP006_CHECK_PARAM((dev == NULL) || (txn == NULL));
     
-    uint16_t currentValue;
-    int status = tmp006_read(dev, TMP006_CONFIG, &currentValue);
-    TMP006_FAIL_UNLESS_OK(status);
+    txn->reg = reg;
+    txn->type = TMP006_TXN_WRITE;
+    txn->data[0] = (uint8_t)(value >> 8);
+    txn->data[1] = (uint8_t)(value & 0x00FF);
+    txn->callback = callback;
+    txn->context = context;
+    startTransaction(dev, txn);
     
-    currentValue &= (~TMP006_CR_MASK);
-    currentValue |= rate;
+    return 0;
+}
+
+int tmp006_poll(const TMP006_Transaction *txn)
+{
+    TMP006_CHECK_PARAM(txn == NULL);
     
-    status = tmp006_write(dev, TMP006_CONFIG, &currentValue);
+    return (txn->status == TMP006_TXN_PENDING) ? -EINPROGRESS : txn->status;
+}
+
+int tmp006_wait(const TMP006_Transaction *txn)
+{
+    TMP006_CHECK_PARAM(txn == NULL);
+    
+    while (txn->status == TMP006_TXN_PENDING)
+    {
+    }
+    
+    return txn->status;
+}
+
+uint16_t tmp006_transactionValue(const TMP006_Transaction *txn)
+{
+    return (uint16_t)(((uint16_t)txn->data[0] << 8) | txn->data[1]); //MSB is received first
+}
+
+int tmp006_read(TMP006_Device *dev, uint8_t reg, uint16_t *data)
+{
+    TMP006_STATS_CALL(TMP006_STATS_READ);
+    TMP006_Transaction txn;
+    TMP006_CHECK_PARAM((dev == NULL) || (data == NULL));
+    
+    int status = tmp006_readAsync(dev, reg, &txn, NULL, NULL);
+    TMP006_FAIL_UNLESS_OK(status);
+    
+    status = tmp006_wait(&txn);
     TMP006_FAIL_UNLESS_OK(status);
     
+    *data = tmp006_transactionValue(&txn);
     return 0;
 }
 
-int tmp006_drdyPinConfig(TMP006_Device *dev, enum TMP006_DRDY_pinMode drdyPin)
+int tmp006_write(TMP006_Device *dev, uint8_t reg, uint16_t *data)
 {
-    TMP006_CHECK_PARAM((dev == NULL) || (drdyPin > TMP006_DRDY_PIN_ON));
+    TMP006_STATS_CALL(TMP006_STATS_WRITE);
+    TMP006_Transaction txn;
+    TMP006_CHECK_PARAM((dev == NULL) || (data == NULL));
     
-    uint16_t currentValue;
-    int status = tmp006_read(dev, TMP006_CONFIG, &currentValue);
+    int status = tmp006_writeAsync(dev, reg, *data, &txn, NULL, NULL);
     TMP006_FAIL_UNLESS_OK(status);
     
-    currentValue &= (~TMP006_DRDY_EN_MASK);
-    currentValue |= drdyPin;
+    return tmp006_wait(&txn);
+}
+
+int tmp006_configConvRate(TMP006_Device *dev, enum TMP006_ConversionRate rate)
+{
+    TMP006_STATS_CALL(TMP006_STATS_UPDATE_CONFIG);
+    TMP006_CHECK_PARAM((dev == NULL) || (rate > TMP006_CONVERSION_RATE_0_25_CONV_PER_SEC));
     
-    status = tmp006_write(dev, TMP006_CONFIG, &currentValue);
-    TMP006_FAIL_UNLESS_OK(status);
+    return updateConfig(dev, TMP006_CR_MASK, (uint16_t)rate);
+}
+
+int tmp006_drdyPinConfig(TMP006_Device *dev, enum TMP006_DRDY_pinMode drdyPin)
+{
+    TMP006_STATS_CALL(TMP006_STATS_UPDATE_CONFIG);
+    TMP006_CHECK_PARAM((dev == NULL) || (drdyPin > TMP006_DRDY_PIN_ON));
     
-    return 0;  
+    return updateConfig(dev, TMP006_DRDY_EN_MASK, (uint16_t)drdyPin);
 }
 
 int tmp006_resetDevice(TMP006_Device *dev)
 {
+    TMP006_STATS_CALL(TMP006_STATS_RESET);
     TMP006_CHECK_PARAM(dev == NULL);
     
     uint16_t val = TMP006_RST_MASK;
@@ -196,23 +383,15 @@ int tmp006_resetDevice(TMP006_Device *dev)
 
 int tmp006_operationMode(TMP006_Device *dev, enum TMP006_OperationMode mode)
 {
+    TMP006_STATS_CALL(TMP006_STATS_UPDATE_CONFIG);
     TMP006_CHECK_PARAM((dev == NULL) || (mode > TMP006_CONTINUOUS_CONVERSION));
     
-    uint16_t currentValue;
-    int status = tmp006_read(dev, TMP006_CONFIG, &currentValue);
-    TMP006_FAIL_UNLESS_OK(status);
-    
-    currentValue &= (~TMP006_MOD_MASK);
-    currentValue |= mode;
-    
-    status = tmp006_write(dev, TMP006_CONFIG, &currentValue);
-    TMP006_FAIL_UNLESS_OK(status);
-    
-    return 0;
+    return updateConfig(dev, TMP006_MOD_MASK, (uint16_t)mode);
 }
 
 int tmp006_isResultReady(TMP006_Device *dev, bool *isReady)
 {
+    TMP006_STATS_CALL(TMP006_STATS_IS_RESULT_READY);
     TMP006_CHECK_PARAM(dev == NULL);
 
     uint16_t currentValue;
@@ -220,12 +399,14 @@ int tmp006_isResultReady(TMP006_Device *dev, bool *isReady)
     TMP006_FAIL_UNLESS_OK(status);
     
     *isReady = currentValue & TMP006_DRDY_RESULT_READY_MASK;
+    updateConfigShadow(dev, currentValue);
     
     return 0;
 }
 
 int tmp006_readTemp(TMP006_Device *dev, int16_t *temperature)
 {
+    TMP006_STATS_CALL(TMP006_STATS_READ_TEMP);
     TMP006_CHECK_PARAM((dev == NULL) || (temperature == NULL));
     
     int status = tmp006_read(dev, TMP006_TEMP_AMBIENT, (uint16_t *)temperature);
@@ -237,6 +418,7 @@ int tmp006_readTemp(TMP006_Device *dev, int16_t *temperature)
 
 int tmp006_readVoltage(TMP006_Device *dev, int16_t *voltage)
 {
+    TMP006_STATS_CALL(TMP006_STATS_READ_VOLTAGE);
     TMP006_CHECK_PARAM((dev == NULL) || (voltage == NULL));
 
     int status = tmp006_read(dev, TMP006_VOBJECT, (uint16_t *)voltage);
@@ -245,9 +427,211 @@ int tmp006_readVoltage(TMP006_Device *dev, int16_t *voltage)
     return 0;
 }
 
+/**@{ Steps of asynchronous sample read */
+#define SAMPLE_STATE_CHECK_READY    0
+#define SAMPLE_STATE_FIRST          1
+#define SAMPLE_STATE_SECOND         2
+/**@}*/
+
+/**
+* @brief Finish sample request
+*/
+static void finishSample(TMP006_SampleRequest *req, int status)
+{
+    req->status = status;
+    if (req->callback != NULL)
+    {
+        req->callback(req);
+    }
+}
+
+/**
+* @brief Store result of finished transaction into sample
+*/
+static void storeSampleValue(TMP006_SampleRequest *req)
+{
+    const int16_t value = (int16_t)tmp006_transactionValue(&req->txn);
+    
+    if (req->txn.reg == TMP006_VOBJECT)
+    {
+        req->sample->voltage = value;
+    }
+    else
+    {
+        req->sample->temperature = value >> 2;
+    }
+}
+
+/**
+* @brief Completion of one transaction of sample request, starts the next one
+*/
+static void sampleStep(TMP006_Transaction *txn)
+{
+    TMP006_SampleRequest *req = (TMP006_SampleRequest *)txn->context;
+    TMP006_Device *dev = txn->dev;
+    
+    if (txn->status != 0)
+    {
+        finishSample(req, txn->status);
+        return;
+    }
+    
+    switch (req->state)
+    {
+        case SAMPLE_STATE_CHECK_READY:
+        {
+            const uint16_t config = tmp006_transactionValue(txn);
+            updateConfigShadow(dev, config);
+            if (!(config & TMP006_DRDY_RESULT_READY_MASK))
+            {
+                finishSample(req, -EAGAIN);
+                return;
+            }
+            //both result registers are equally far, voltage first
+            req->state = SAMPLE_STATE_FIRST;
+            tmp006_readAsync(dev, TMP006_VOBJECT, txn, sampleStep, req);
+            break;
+        }
+        case SAMPLE_STATE_FIRST:
+        {
+            storeSampleValue(req);
+            req->state = SAMPLE_STATE_SECOND;
+            tmp006_readAsync(dev, (txn->reg == TMP006_VOBJECT) ? TMP006_TEMP_AMBIENT : TMP006_VOBJECT,
+                             txn, sampleStep, req);
+            break;
+        }
+        default:
+        {
+            storeSampleValue(req);
+            req->sample->timestamp = (dev->getTime != NULL) ? dev->getTime() : 0;
+            finishSample(req, 0);
+            break;
+        }
+    }
+}
+
+int tmp006_readSampleAsync(TMP006_Device *dev, TMP006_Sample *sample, bool checkReady, TMP006_SampleRequest *req,
+                           void (*callback)(TMP006_SampleRequest *req), void *context)
+{
+    TMP006_CHECK_PARAM((dev == NULL) || (sample == NULL) || (req == NULL));
+    
+    req->sample = sample;
+    req->checkReady = checkReady;
+    req->callback = callback;
+    req->context = context;
+    req->status = TMP006_TXN_PENDING;
+    
+    if (checkReady)
+    {
+        req->state = SAMPLE_STATE_CHECK_READY;
+        return tmp006_readAsync(dev, TMP006_CONFIG, &req->txn, sampleStep, req);
+    }
+    
+    //register device pointer already points to is read first
+    req->state = SAMPLE_STATE_FIRST;
+    const uint8_t first = (dev->pointerRegValid && (dev->pointerReg == TMP006_TEMP_AMBIENT)) ?
+                          TMP006_TEMP_AMBIENT : TMP006_VOBJECT;
+    
+    return tmp006_readAsync(dev, first, &req->txn, sampleStep, req);
+}
 
+int tmp006_readSample(TMP006_Device *dev, TMP006_Sample *sample, bool checkReady)
+{
+    TMP006_STATS_CALL(TMP006_STATS_READ_SAMPLE);
+    TMP006_SampleRequest req;
+    
+    int status = tmp006_readSampleAsync(dev, sample, checkReady, &req, NULL, NULL);
+    TMP006_FAIL_UNLESS_OK(status);
+    
+    while (req.status == TMP006_TXN_PENDING)
+    {
+    }
+    
+    return req.status;
+}
 
+int tmp006_configure(TMP006_Device *dev, const TMP006_Config *cfg)
+{
+    TMP006_STATS_CALL(TMP006_STATS_CONFIGURE);
+    TMP006_CHECK_PARAM((dev == NULL) || (cfg == NULL));
+    TMP006_CHECK_PARAM((cfg->mode > TMP006_CONTINUOUS_CONVERSION) ||
+                       (cfg->rate > TMP006_CONVERSION_RATE_0_25_CONV_PER_SEC) ||
+                       (cfg->drdyPin > TMP006_DRDY_PIN_ON));
+    
+    //RST is a separate write, bits written together with it are lost
+    if (cfg->reset)
+    {
+        int status = tmp006_resetDevice(dev);
+        TMP006_FAIL_UNLESS_OK(status);
+    }
+    
+    uint16_t value = (uint16_t)(cfg->mode | cfg->rate | cfg->drdyPin);
+    
+    //all bits are given, there is no need to read the register first
+    if (dev->configShadowValid && (dev->configShadow == value))
+    {
+        dev->savedTransactions++;
+        return 0;
+    }
+    
+    return tmp006_write(dev, TMP006_CONFIG, &value);
+}
 
+int tmp006_syncConfig(TMP006_Device *dev)
+{
+    TMP006_STATS_CALL(TMP006_STATS_SYNC_CONFIG);
+    TMP006_CHECK_PARAM(dev == NULL);
+    
+    uint16_t currentValue;
+    int status = tmp006_read(dev, TMP006_CONFIG, &currentValue);
+    TMP006_FAIL_UNLESS_OK(status);
+    
+    updateConfigShadow(dev, currentValue);
+    
+    return 0;
+}
 
+uint32_t tmp006_conversionPeriodMs(enum TMP006_ConversionRate rate)
+{
+    //period doubles with every step of CR bits, higher codes are 0.25 conv/sec as well
+    uint8_t cr = (uint8_t)(((uint16_t)rate & TMP006_CR_MASK) >> 9);
+    if (cr > 4)
+    {
+        cr = 4;
+    }
+    
+    return 250u << cr;
+}
 
+uint32_t tmp006_savedTransactions(const TMP006_Device *dev)
+{
+    if (dev == NULL)
+    {
+        return 0;
+    }
+    
+    return dev->savedTransactions;
+}
 
+int tmp006_setI2cSpeed(TMP006_Device *dev, uint32_t speedHz, uint32_t *achievedHz)
+{
+    TMP006_CHECK_PARAM((dev == NULL) || (speedHz == 0) || (speedHz > TMP006_I2C_FAST_MODE));
+    
+    if (dev->i2cSetSpeed == NULL)
+    {
+        return -ENOTSUP;
+    }
+    
+    const uint32_t achieved = dev->i2cSetSpeed(speedHz);
+    if (achieved == 0)
+    {
+        return -ENOTSUP;
+    }
+    
+    if (achievedHz != NULL)
+    {
+        *achievedHz = achieved;
+    }
+    
+    return 0;
+}
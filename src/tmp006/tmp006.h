@@ -14,6 +14,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <errno.h>
 
 /**@{ TMP006 register map */
 #define TMP006_VOBJECT          0x00      
@@ -23,6 +24,18 @@ extern "C" {
 #define TMP006_DEVICE_ID        0xFF
 /**@}*/
 
+/**@{ Errors reported by transport through tmp006_read(), tmp006_write() and transactions */
+#define TMP006_ERR_ADDR_NACK    (-ENXIO)      /**< No device on the address */
+#define TMP006_ERR_DATA_NACK    (-EIO)        /**< Device didn't acknowledge data */
+#define TMP006_ERR_ARB_LOST     (-ECOMM)      /**< Another master took the bus, -EAGAIN means result not ready */
+#define TMP006_ERR_TIMEOUT      (-ETIMEDOUT)  /**< Transaction wasn't finished before deadline */
+/**@}*/
+
+/**@{ I2C bus speeds supported by TMP006 */
+#define TMP006_I2C_STANDARD_MODE    100000u  /**< 100 kHz SCL */
+#define TMP006_I2C_FAST_MODE        400000u  /**< 400 kHz SCL */
+/**@}*/
+
 /**@{ Register masks */
 #define TMP006_RST_MASK                0x8000
 #define TMP006_MOD_MASK                0x7000
@@ -32,6 +45,9 @@ extern "C" {
 
 /**@}*/
 
+/** @brief Value of CONFIG register after power-on or software reset */
+#define TMP006_CONFIG_DEFAULT           0x7400
+
 #define TMP006_MANUF_ID_VALUE           0x5449
 #define TMP006_DEVICE_ID_VALUE          0x0067
 /**
@@ -76,6 +92,61 @@ enum TMP006_DRDY_pinMode
     TMP006_DRDY_PIN_ON  = (1 << 8)
 };
 
+/**
+* @brief Complete configuration of TMP006, used by tmp006_configure()
+*/
+typedef struct TMP006_Config
+{
+    enum TMP006_OperationMode  mode;    /**< Operation mode */
+    enum TMP006_ConversionRate rate;    /**< Conversion rate */
+    enum TMP006_DRDY_pinMode   drdyPin; /**< DRDY pin mode */
+    bool reset;                         /**< Reset device before configuration */
+} TMP006_Config;
+
+/**
+* @brief One conversion result of TMP006, used by tmp006_readSample()
+*/
+typedef struct TMP006_Sample
+{
+    int16_t  voltage;     /**< Sensor voltage, LSB = 156.25 nV */
+    int16_t  temperature; /**< Die temperature, LSB = 1/32 C */
+    uint32_t timestamp;   /**< Value of device time source when sample was read */
+} TMP006_Sample;
+
+/** @brief Status of transaction that is not finished yet */
+#define TMP006_TXN_PENDING      1
+
+/**
+* @brief Type of I2C transaction
+*/
+enum TMP006_TransactionType
+{
+    TMP006_TXN_READ,          /**< Write pointer register, repeated start, read 2 bytes */
+    TMP006_TXN_WRITE,         /**< Write pointer register and 2 bytes */
+    TMP006_TXN_READ_CURRENT   /**< Read 2 bytes from register pointer already points to */
+};
+
+struct TMP006_Device;
+
+/**
+* @brief Descriptor of one register access
+*
+* Filled by the driver and passed to the transport. Transport reports the
+* result with tmp006_complete(), which may be called from interrupt context.
+*/
+typedef struct TMP006_Transaction
+{
+    struct TMP006_Device *dev;   /**< Device that started the transaction */
+    uint8_t  addr;               /**< I2C address of device */
+    uint8_t  reg;                /**< Register address */
+    uint8_t  type;               /**< Value of TMP006_TransactionType */
+    uint8_t  data[2];            /**< Data to send or received data, MSB first */
+    uint32_t timeoutUs;          /**< Deadline of transaction in microseconds, 0 for transport default */
+    volatile int status;         /**< TMP006_TXN_PENDING, 0 on success or an error code */
+    void (*callback)(struct TMP006_Transaction *txn); /**< Optional, called on completion */
+    void *context;               /**< User data for callback */
+} TMP006_Transaction;
+
 /**
 * @brief TMP006 device structure
 */
@@ -89,10 +160,43 @@ typedef struct TMP006_Device
                     uint8_t reg, 
                     uint8_t *data, 
                     uint16_t length);
+    int (*i2cReadCurrent)(uint8_t addr,
+                          uint8_t *data,
+                          uint16_t length); //**< Optional, read without writing pointer register first */
+    
+    int (*i2cStart)(TMP006_Transaction *txn); //**< Optional, start transaction without waiting for it */
+    
+    uint32_t (*getTime)(void); //**< Optional time source used to timestamp samples */
+    
+    uint32_t (*i2cSetSpeed)(uint32_t speedHz); /**< Optional, set SCL rate, returns achieved rate or 0 */
     
     uint8_t  i2cAddress; /**< I2C address depended on ADR0 and ADR1 pin */
+    uint32_t timeoutUs;  /**< Deadline of each transaction in microseconds, 0 for transport default.
+                              Can be changed between calls. Blocking i2cRead() and i2cWrite()
+                              get no deadline, only i2cStart() transports honour it. */
+    
+    uint8_t  pointerReg;        /**< Last value written to device pointer register */
+    bool     pointerRegValid;   /**< Set when pointerReg is known to match the device */
+    
+    uint16_t configShadow;      /**< Cached copy of CONFIG register, without DRDY status bit */
+    bool     configShadowValid; /**< Set when configShadow is known to match the device */
+    uint32_t savedTransactions; /**< Number of I2C transactions avoided by using configShadow */
 } TMP006_Device;
 
+/**
+* @brief State of asynchronous sample read, used by tmp006_readSampleAsync()
+*/
+typedef struct TMP006_SampleRequest
+{
+    TMP006_Transaction txn;      /**< Transaction in progress */
+    TMP006_Sample *sample;       /**< Where the result is stored */
+    uint8_t  state;              /**< Step of the read */
+    bool     checkReady;         /**< Check DRDY bit first */
+    volatile int status;         /**< TMP006_TXN_PENDING, 0 on success or an error code */
+    void (*callback)(struct TMP006_SampleRequest *req); /**< Optional, called on completion */
+    void *context;               /**< User data for callback */
+} TMP006_SampleRequest;
+
 /**
 * @brief Initialize TMP006 device structure 
 * 
@@ -105,7 +209,10 @@ typedef struct TMP006_Device
 * @returns error code on failure
 * 
 * @note Before you use this function you need to initialize i2cRead() and i2cWrite()
-* functions from TMP006_Device structure
+* functions from TMP006_Device structure. i2cReadCurrent() is optional, if it is set
+* consecutive reads of the same register skip the pointer register write.
+* i2cStart() is optional, if it is set all transactions go through it and
+* asynchronous functions return before transaction is finished.
 */
 int tmp006_init(TMP006_Device *dev,enum TMP006_PinState A0state, enum TMP006_PinState A1state);
 
@@ -117,6 +224,8 @@ int tmp006_init(TMP006_Device *dev,enum TMP006_PinState A0state, enum TMP006_Pin
 * @param data Pointer to a 2 bytes where data will be stored.
 * 
 * @returns 0 on success or an error code
+* @returns TMP006_ERR_ADDR_NACK, TMP006_ERR_DATA_NACK, TMP006_ERR_ARB_LOST or
+* TMP006_ERR_TIMEOUT if transport reports bus error
 */
 int tmp006_read(TMP006_Device *dev, uint8_t reg, uint16_t *data);
 
@@ -128,6 +237,8 @@ int tmp006_read(TMP006_Device *dev, uint8_t reg, uint16_t *data);
 * @param data Pointer to a 2 bytes which you want to send.
 * 
 * @returns 0 on success or an error code
+* @returns TMP006_ERR_ADDR_NACK, TMP006_ERR_DATA_NACK, TMP006_ERR_ARB_LOST or
+* TMP006_ERR_TIMEOUT if transport reports bus error
 */
 int tmp006_write(TMP006_Device *dev, uint8_t reg, uint16_t *data);
 
@@ -198,6 +309,24 @@ int tmp006_readTemp(TMP006_Device *dev, int16_t *temperature);
 */
 int tmp006_readVoltage(TMP006_Device *dev, int16_t *voltage);
 
+/**
+* @brief Read voltage and ambient temperature of one conversion.
+*
+* Both result registers are read back-to-back. The register device pointer already
+* points to is read first, so with i2cReadCurrent() set only one pointer write is needed.
+* Sample is timestamped with getTime() from device structure, or 0 if it's not set.
+*
+* @param[in] dev Pointer to the TMP006 device structure
+* @param[out] sample Pointer to structure where sample will be stored.
+* @param[in] checkReady If true, DRDY bit is checked first so stale result is never returned.
+*
+* @returns 0 on success or an error code
+* @returns -EAGAIN if checkReady is set and conversion is not finished
+*
+* @note Values have the same format as outputs of tmp006_readVoltage() and tmp006_readTemp()
+*/
+int tmp006_readSample(TMP006_Device *dev, TMP006_Sample *sample, bool checkReady);
+
 /**
 * @brief Set the TMP006 operation mode.
 * 
@@ -221,6 +350,180 @@ int tmp006_operationMode(TMP006_Device *dev, enum TMP006_OperationMode mode);
 */
 int tmp006_isResultReady(TMP006_Device *dev, bool *isReady);
 
+/**
+* @brief Configure operation mode, conversion rate and DRDY pin at once.
+*
+* All fields are composed into one CONFIG value which is sent with a single
+* write. If reset is requested it is performed first, and the configuration
+* write is skipped when the requested value equals the reset default.
+*
+* @note With reset the call makes two writes. RST bit clears itself and the
+* device ignores the other bits of the write that sets it, so reset can't be
+* folded into the configuration write.
+*
+* @param dev Pointer to the TMP006 device structure
+* @param cfg Pointer to the required configuration
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_configure(TMP006_Device *dev, const TMP006_Config *cfg);
+
+/**
+* @brief Resync cached CONFIG register from hardware.
+*
+* Setters keep a shadow copy of CONFIG so they need only one write per change
+* and skip writes that would not change the register. Call this function if
+* the device could have been changed behind the driver's back
+* (e.g. power cycle of the sensor without MCU reset).
+*
+* @param dev Pointer to the TMP006 device structure
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_syncConfig(TMP006_Device *dev);
+
+/**
+* @brief Get nominal time between two conversions.
+*
+* @param rate Conversion rate
+*
+* @returns period in milliseconds, 250 - 4000
+*/
+uint32_t tmp006_conversionPeriodMs(enum TMP006_ConversionRate rate);
+
+/**
+* @brief Get number of I2C transactions saved by the CONFIG shadow.
+*
+* @param dev Pointer to the TMP006 device structure
+*
+* @returns number of avoided transactions since tmp006_init(), 0 if dev is NULL
+*/
+uint32_t tmp006_savedTransactions(const TMP006_Device *dev);
+
+/**
+* @brief Change SCL rate of the bus device is connected to.
+*
+* Speed applies to every device on the same bus. Transport rounds it down to
+* the closest rate it can generate.
+*
+* @param dev Pointer to the TMP006 device structure
+* @param speedHz Requested rate, TMP006_I2C_STANDARD_MODE or TMP006_I2C_FAST_MODE
+* @param achievedHz Pointer where achieved rate will be stored, may be NULL
+*
+* @returns 0 on success, -ENOTSUP if transport has no i2cSetSpeed() or can't
+* generate requested rate, or other error code
+*
+* @note Must not be called while a transaction is in progress.
+*/
+int tmp006_setI2cSpeed(TMP006_Device *dev, uint32_t speedHz, uint32_t *achievedHz);
+
+/**
+* @brief Start read of TMP006 register.
+*
+* @param dev Pointer to the TMP006 device structure
+* @param reg Adress of register from which you want to read.
+* @param txn Pointer to transaction, must be valid until it's finished
+* @param callback Function called when transaction is finished, may be NULL
+* @param context User data for callback
+*
+* @returns 0 if transaction was started or an error code
+*
+* @note Result is in txn->status, read value is returned by tmp006_transactionValue().
+* If transport has no i2cStart() transaction is finished before this function returns.
+* Only one transaction per device may be in progress.
+*/
+int tmp006_readAsync(TMP006_Device *dev, uint8_t reg, TMP006_Transaction *txn,
+                     void (*callback)(TMP006_Transaction *txn), void *context);
+
+/**
+* @brief Prepare read of TMP006 register without starting it.
+*
+* Used to build arrays of transactions that transport performs back-to-back,
+* e.g. with platform_i2cSubmit(). Transport must call tmp006_complete() for it.
+*
+* @param dev Pointer to the TMP006 device structure
+* @param reg Adress of register from which you want to read.
+* @param txn Pointer to transaction
+*
+* @returns 0 on success or an error code
+*
+* @note Pointer register write is always included, because state of the device
+* pointer is not known until previous transactions are finished.
+*/
+int tmp006_prepareRead(TMP006_Device *dev, uint8_t reg, TMP006_Transaction *txn);
+
+/**
+* @brief Start write to TMP006 register.
+*
+* @param dev Pointer to the TMP006 device structure
+* @param reg Adress of register to which you want to write.
+* @param value Value to write
+* @param txn Pointer to transaction, must be valid until it's finished
+* @param callback Function called when transaction is finished, may be NULL
+* @param context User data for callback
+*
+* @returns 0 if transaction was started or an error code
+*/
+int tmp006_writeAsync(TMP006_Device *dev, uint8_t reg, uint16_t value, TMP006_Transaction *txn,
+                      void (*callback)(TMP006_Transaction *txn), void *context);
+
+/**
+* @brief Start read of voltage and ambient temperature of one conversion.
+*
+* Works as tmp006_readSample(), but returns right after the first transaction is started.
+* Next transactions are started from completion of previous ones.
+*
+* @param dev Pointer to the TMP006 device structure
+* @param[out] sample Pointer to structure where sample will be stored, valid when request is finished.
+* @param checkReady If true, DRDY bit is checked first, request finishes with -EAGAIN if not ready.
+* @param req Pointer to request, must be valid until it's finished
+* @param callback Function called when request is finished, may be NULL
+* @param context User data for callback
+*
+* @returns 0 if request was started or an error code
+*/
+int tmp006_readSampleAsync(TMP006_Device *dev, TMP006_Sample *sample, bool checkReady, TMP006_SampleRequest *req,
+                           void (*callback)(TMP006_SampleRequest *req), void *context);
+
+/**
+* @brief Check state of transaction.
+*
+* @param txn Pointer to transaction
+*
+* @returns -EINPROGRESS if transaction is not finished, otherwise its status
+*/
+int tmp006_poll(const TMP006_Transaction *txn);
+
+/**
+* @brief Wait until transaction is finished.
+*
+* @param txn Pointer to transaction
+*
+* @returns status of transaction
+*/
+int tmp006_wait(const TMP006_Transaction *txn);
+
+/**
+* @brief Get value read by finished read transaction.
+*
+* @param txn Pointer to transaction
+*
+* @returns value of register
+*/
+uint16_t tmp006_transactionValue(const TMP006_Transaction *txn);
+
+/**
+* @brief Report end of transaction, called by transport.
+*
+* Updates cached state of device and calls transaction callback.
+*
+* @param txn Pointer to finished transaction
+* @param status 0 on success or an error code
+*
+* @note May be called from interrupt context.
+*/
+void tmp006_complete(TMP006_Transaction *txn, int status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,421 @@
+/**
+* @file tmp006_bus.c
+* @brief Manager of up to eight TMP006 devices on one I2C bus
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_bus.h"
+
+#include <errno.h>
+#include <stddef.h>
+
+/**
+ * Helper macro for error handling
+ *
+ * @note Guaranteed to only perform one evaluation of `status`
+ */
+#define TMP006_FAIL_UNLESS_OK(status) \
+    do                                  \
+    {                                   \
+        int temp = (status);            \
+        if (0 != temp)                  \
+        {                               \
+            return temp;                \
+        }                               \
+    } while (0)
+/**@{ Pending devices are added by interrupt and taken by consumer */
+#if defined(__GNUC__)
+#define BUS_PENDING_ADD(pending, mask)  __atomic_fetch_or(&(pending), (mask), __ATOMIC_RELAXED)
+#define BUS_PENDING_TAKE(pending)       __atomic_exchange_n(&(pending), 0, __ATOMIC_ACQUIRE)
+#else
+//edge which comes inside read-modify-write can be lost, ARMCLANG and GCC take the branch above
+#define BUS_PENDING_ADD(pending, mask)  ((pending) |= (mask))
+#define BUS_PENDING_TAKE(pending)       takePending(&(pending))
+static uint8_t takePending(volatile uint8_t *pending)
+{
+    const uint8_t value = *pending;
+    *pending &= (uint8_t)~value;
+    return value;
+}
+#endif
+/**@}*/
+
+/*
+* Helper macro for parametar checking
+*/
+#define TMP006_CHECK_PARAM(expr) \
+    do                           \
+    {                            \
+        if (expr)                \
+        {                        \
+            return -EINVAL;      \
+        }                        \
+    } while (0)
+
+/**@{ Bits of TMP006_BusDevice flags */
+#define BUS_FLAG_SHADOW_VALID   0x01
+#define BUS_FLAG_POINTER_VALID  0x02
+/**@}*/
+
+int tmp006_busPrepareSweep(TMP006_Bus *bus, TMP006_Transaction *txns, uint16_t *count)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (txns == NULL) || (count == NULL));
+    
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        TMP006_Device *dev = tmp006_busAcquire(bus, i);
+        tmp006_prepareRead(dev, TMP006_VOBJECT, &txns[2 * i]);
+        tmp006_prepareRead(dev, TMP006_TEMP_AMBIENT, &txns[(2 * i) + 1]);
+    }
+    *count = (uint16_t)(2 * bus->deviceCount);
+    
+    return 0;
+}
+
+int tmp006_busSweepResult(TMP006_Bus *bus, const TMP006_Transaction *txns, TMP006_Sample *samples, uint8_t *readyMask)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (txns == NULL) || (samples == NULL) || (readyMask == NULL));
+    
+    const uint32_t timestamp = (bus->dev.getTime != NULL) ? bus->dev.getTime() : 0;
+    int result = 0;
+    *readyMask = 0;
+    
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        const TMP006_Transaction *voltage = &txns[2 * i];
+        const TMP006_Transaction *temperature = &txns[(2 * i) + 1];
+        
+        //device points to the last register that was read successfully
+        TMP006_BusDevice *record = &bus->devices[i];
+        record->pointerReg = TMP006_TEMP_AMBIENT;
+        record->flags &= (uint8_t)~BUS_FLAG_POINTER_VALID;
+        if (temperature->status == 0)
+        {
+            record->flags |= BUS_FLAG_POINTER_VALID;
+        }
+        
+        if ((voltage->status != 0) || (temperature->status != 0))
+        {
+            result = (result != 0) ? result : ((voltage->status != 0) ? voltage->status : temperature->status);
+            continue;
+        }
+        
+        samples[i].voltage = (int16_t)tmp006_transactionValue(voltage);
+        samples[i].temperature = (int16_t)tmp006_transactionValue(temperature) >> 2;
+        samples[i].timestamp = timestamp;
+        *readyMask |= (uint8_t)(1 << i);
+    }
+    
+    return result;
+}
+
+TMP006_Device *tmp006_busAcquire(TMP006_Bus *bus, uint8_t index)
+{
+    if ((bus == NULL) || (index >= bus->deviceCount))
+    {
+        return NULL;
+    }
+    
+    const TMP006_BusDevice *record = &bus->devices[index];
+    bus->dev.i2cAddress = record->i2cAddress;
+    bus->dev.configShadow = record->configShadow;
+    bus->dev.configShadowValid = (record->flags & BUS_FLAG_SHADOW_VALID) != 0;
+    bus->dev.pointerReg = record->pointerReg;
+    bus->dev.pointerRegValid = (record->flags & BUS_FLAG_POINTER_VALID) != 0;
+    
+    return &bus->dev;
+}
+
+void tmp006_busRelease(TMP006_Bus *bus, uint8_t index)
+{
+    if ((bus == NULL) || (index >= bus->deviceCount))
+    {
+        return;
+    }
+    
+    TMP006_BusDevice *record = &bus->devices[index];
+    record->configShadow = bus->dev.configShadow;
+    record->pointerReg = bus->dev.pointerReg;
+    record->flags = (uint8_t)((bus->dev.configShadowValid ? BUS_FLAG_SHADOW_VALID : 0) |
+                              (bus->dev.pointerRegValid ? BUS_FLAG_POINTER_VALID : 0));
+}
+
+int tmp006_busInit(TMP006_Bus *bus, const TMP006_Device *transport)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (transport == NULL));
+    TMP006_CHECK_PARAM((transport->i2cRead == NULL) || (transport->i2cWrite == NULL));
+    
+    bus->dev = *transport;
+    bus->deviceCount = 0;
+    bus->next = 0;
+    bus->drdyPending = 0;
+    
+    return 0;
+}
+
+int tmp006_busAdd(TMP006_Bus *bus, enum TMP006_PinState A0state, enum TMP006_PinState A1state,
+                  uint8_t weight, uint8_t *index)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (weight == 0));
+    
+    if (bus->deviceCount >= TMP006_BUS_MAX_DEVICES)
+    {
+        return -ENOSPC;
+    }
+    
+    //shared counter of saved transactions is kept
+    const uint32_t savedTransactions = bus->dev.savedTransactions;
+    int status = tmp006_init(&bus->dev, A0state, A1state);
+    bus->dev.savedTransactions = savedTransactions;
+    TMP006_FAIL_UNLESS_OK(status);
+    
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        if (bus->devices[i].i2cAddress == bus->dev.i2cAddress)
+        {
+            return -EEXIST;
+        }
+    }
+    
+    const uint8_t newIndex = bus->deviceCount++;
+    bus->devices[newIndex].i2cAddress = bus->dev.i2cAddress;
+    bus->devices[newIndex].weight = weight;
+    bus->devices[newIndex].credit = 0;
+    tmp006_busRelease(bus, newIndex);
+    
+    if (index != NULL)
+    {
+        *index = newIndex;
+    }
+    
+    return 0;
+}
+
+int tmp006_scanBus(TMP006_Bus *bus, uint8_t *foundMask)
+{
+    //ADR0 and ADR1 states in order of addresses 0x40 - 0x47
+    static const enum TMP006_PinState adr1States[4] = {
+        TMP006_PIN_LOW, TMP006_PIN_HIGH, TMP006_PIN_SDA, TMP006_PIN_SCL
+    };
+    
+    TMP006_CHECK_PARAM(bus == NULL);
+    
+    bus->deviceCount = 0;
+    bus->next = 0;
+    uint8_t found = 0;
+    
+    //probes go through a copy of transport, shared state of the bus is kept
+    TMP006_Device probe = bus->dev;
+    for (uint8_t i = 0; i < TMP006_BUS_MAX_DEVICES; i++)
+    {
+        const enum TMP006_PinState adr0 = (i < 4) ? TMP006_PIN_LOW : TMP006_PIN_HIGH;
+        int status = tmp006_init(&probe, adr0, adr1States[i & 3]);
+        TMP006_FAIL_UNLESS_OK(status);
+        
+        uint16_t id;
+        if ((tmp006_read(&probe, TMP006_MANUFACTURER_ID, &id) != 0) || (id != TMP006_MANUF_ID_VALUE))
+        {
+            continue;
+        }
+        if ((tmp006_read(&probe, TMP006_DEVICE_ID, &id) != 0) || (id != TMP006_DEVICE_ID_VALUE))
+        {
+            continue;
+        }
+        
+        uint8_t index;
+        status = tmp006_busAdd(bus, adr0, adr1States[i & 3], 1, &index);
+        TMP006_FAIL_UNLESS_OK(status);
+        found |= (uint8_t)(1 << i);
+        
+        //device points to its ID register, the next read doesn't have to write the pointer
+        TMP006_Device *dev = tmp006_busAcquire(bus, index);
+        dev->pointerReg = probe.pointerReg;
+        dev->pointerRegValid = probe.pointerRegValid;
+        tmp006_busRelease(bus, index);
+    }
+    
+    if (foundMask != NULL)
+    {
+        *foundMask = found;
+    }
+    
+    return 0;
+}
+
+int tmp006_busConfigure(TMP006_Bus *bus, uint8_t index, const TMP006_Config *cfg)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (cfg == NULL));
+    TMP006_CHECK_PARAM((index >= bus->deviceCount) && (index != TMP006_BUS_MAX_DEVICES));
+    
+    const uint8_t first = (index == TMP006_BUS_MAX_DEVICES) ? 0 : index;
+    const uint8_t last = (index == TMP006_BUS_MAX_DEVICES) ? bus->deviceCount : (uint8_t)(index + 1);
+    
+    for (uint8_t i = first; i < last; i++)
+    {
+        int status = tmp006_configure(tmp006_busAcquire(bus, i), cfg);
+        tmp006_busRelease(bus, i);
+        TMP006_FAIL_UNLESS_OK(status);
+    }
+    
+    return 0;
+}
+
+/**
+* @brief Read sample of one device, not ready device is not an error
+*/
+static int sampleDevice(TMP006_Bus *bus, uint8_t index, TMP006_Sample *sample, bool checkReady, uint8_t *readyMask)
+{
+    int status = tmp006_readSample(tmp006_busAcquire(bus, index), sample, checkReady);
+    tmp006_busRelease(bus, index);
+    
+    if (status == -EAGAIN)
+    {
+        return 0;
+    }
+    TMP006_FAIL_UNLESS_OK(status);
+    
+    *readyMask |= (uint8_t)(1 << index);
+    
+    return 0;
+}
+
+int tmp006_busSampleAll(TMP006_Bus *bus, TMP006_Sample *samples, bool checkReady, uint8_t *readyMask)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (samples == NULL) || (readyMask == NULL));
+    
+    *readyMask = 0;
+    if (bus->deviceCount == 0)
+    {
+        return 0;
+    }
+    
+    int result = 0;
+    uint8_t index = bus->next;
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        //failed device does not stop the sweep
+        int status = sampleDevice(bus, index, &samples[index], checkReady, readyMask);
+        result = (result == 0) ? status : result;
+        
+        index = (uint8_t)((index + 1) % bus->deviceCount);
+    }
+    bus->next = (uint8_t)((bus->next + 1) % bus->deviceCount);
+    
+    return result;
+}
+
+int tmp006_busSamplePriority(TMP006_Bus *bus, TMP006_Sample *samples, uint8_t maxDevices, uint8_t *readyMask)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (samples == NULL) || (readyMask == NULL));
+    
+    *readyMask = 0;
+    if (maxDevices > bus->deviceCount)
+    {
+        maxDevices = bus->deviceCount;
+    }
+    
+    int32_t totalWeight = 0;
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        totalWeight += bus->devices[i].weight;
+    }
+    
+    //device whose share is a read per call or more is read always, without credit
+    uint8_t always = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (uint8_t i = 0; i < bus->deviceCount; i++)
+        {
+            if (((always & (1 << i)) == 0) && (maxDevices > 0) &&
+                (((int32_t)maxDevices * bus->devices[i].weight) >= totalWeight))
+            {
+                always |= (uint8_t)(1 << i);
+                maxDevices--;
+                totalWeight -= bus->devices[i].weight;
+                changed = true;
+            }
+        }
+    }
+    
+    //others get weight for each read of the call and pay the sum of weights for the read they get,
+    //so credits sum to zero and each stays within about one sum of weights
+    uint8_t picked = always;
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        bus->devices[i].credit = (always & (1 << i)) ? 0 :
+                                 (bus->devices[i].credit + (int32_t)maxDevices * bus->devices[i].weight);
+    }
+    for (uint8_t n = 0; n < maxDevices; n++)
+    {
+        uint8_t best = TMP006_BUS_MAX_DEVICES;
+        for (uint8_t i = 0; i < bus->deviceCount; i++)
+        {
+            if (((picked & (1 << i)) == 0) &&
+                ((best == TMP006_BUS_MAX_DEVICES) || (bus->devices[i].credit > bus->devices[best].credit)))
+            {
+                best = i;
+            }
+        }
+        bus->devices[best].credit -= totalWeight;
+        picked |= (uint8_t)(1 << best);
+    }
+    
+    int result = 0;
+    for (uint8_t i = 0; i < bus->deviceCount; i++)
+    {
+        if (picked & (1 << i))
+        {
+            //failed device does not stop the others
+            int status = sampleDevice(bus, i, &samples[i], false, readyMask);
+            result = (result == 0) ? status : result;
+        }
+    }
+    
+    return result;
+}
+
+void tmp006_busDrdy(TMP006_Bus *bus, uint8_t readyMask)
+{
+    //pins are numbered by address, pending bits by device index
+    uint8_t pending = 0;
+    for (uint8_t index = 0; index < bus->deviceCount; index++)
+    {
+        if (readyMask & (1 << (bus->devices[index].i2cAddress & 0x07)))
+        {
+            pending |= (uint8_t)(1 << index);
+        }
+    }
+    
+    BUS_PENDING_ADD(bus->drdyPending, pending);
+}
+
+int tmp006_busSamplePending(TMP006_Bus *bus, TMP006_Sample *samples, uint8_t *readyMask)
+{
+    TMP006_CHECK_PARAM((bus == NULL) || (samples == NULL) || (readyMask == NULL));
+    
+    *readyMask = 0;
+    const uint8_t pending = BUS_PENDING_TAKE(bus->drdyPending);
+    
+    int result = 0;
+    for (uint8_t index = 0; index < bus->deviceCount; index++)
+    {
+        if (pending & (1 << index))
+        {
+            //failed device does not stop the others
+            int status = sampleDevice(bus, index, &samples[index], false, readyMask);
+            result = (result == 0) ? status : result;
+        }
+    }
+    
+    return result;
+}
+
+int tmp006_busSetSpeed(TMP006_Bus *bus, uint32_t speedHz, uint32_t *achievedHz)
+{
+    TMP006_CHECK_PARAM(bus == NULL);
+    
+    return tmp006_setI2cSpeed(&bus->dev, speedHz, achievedHz);
+}
@@ -0,0 +1,232 @@
+/**
+* @file tmp006_bus.h
+* @brief Manager of up to eight TMP006 devices on one I2C bus
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TMP006_BUS_H
+#define TMP006_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tmp006.h"
+
+/** @brief Maximum number of devices on one bus, limited by ADR0 and ADR1 pins */
+#define TMP006_BUS_MAX_DEVICES  8
+
+/**
+* @brief State of one device on the bus
+*
+* Only the data that differs between devices is kept, transport is shared.
+*/
+typedef struct TMP006_BusDevice
+{
+    uint16_t configShadow; /**< Cached copy of CONFIG register */
+    uint8_t  i2cAddress;   /**< I2C address of device */
+    uint8_t  pointerReg;   /**< Last value written to device pointer register */
+    uint8_t  flags;        /**< Validity of configShadow and pointerReg */
+    uint8_t  weight;       /**< Priority, relative number of samples in tmp006_busSamplePriority() */
+    int32_t  credit;       /**< Weighted round-robin state, stays within about +-sum of weights */
+} TMP006_BusDevice;
+
+/**
+* @brief TMP006 bus structure
+*/
+typedef struct TMP006_Bus
+{
+    TMP006_Device    dev;         /**< Shared transport, holds state of device in use */
+    TMP006_BusDevice devices[TMP006_BUS_MAX_DEVICES];
+    uint8_t          deviceCount; /**< Number of devices added to the bus */
+    uint8_t          next;        /**< First device of next round-robin sweep */
+    volatile uint8_t drdyPending; /**< Bit i is set if DRDY of device with index i fell and sample wasn't read yet */
+} TMP006_Bus;
+
+/**
+* @brief Initialize bus structure.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param transport Device structure with initialized transport functions
+* (i2cRead, i2cWrite and optionally i2cReadCurrent, i2cSetSpeed and getTime), it is copied into bus.
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_busInit(TMP006_Bus *bus, const TMP006_Device *transport);
+
+/**
+* @brief Add device to the bus.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param A0state State of pin A0
+* @param A1state State of pin A1
+* @param weight Priority of device used by tmp006_busSamplePriority(), 1 - 255
+* @param[out] index Index of device on the bus, may be NULL
+*
+* @returns 0 on success or an error code
+* @returns -ENOSPC if bus is full
+* @returns -EEXIST if device with the same address is already on the bus
+*/
+int tmp006_busAdd(TMP006_Bus *bus, enum TMP006_PinState A0state, enum TMP006_PinState A1state,
+                  uint8_t weight, uint8_t *index);
+
+/**
+* @brief Find devices on the bus and add them.
+*
+* All eight addresses are probed by reading manufacturer ID. Only if it matches,
+* device ID is read too, so absent address costs one failed transaction that ends
+* on address NACK. Devices already added to the bus are removed first.
+*
+* Probes are sequential blocking reads, not one submitted batch, because the device ID
+* read depends on the result of the first one. They use a copy of the transport, so
+* savedTransactions of the bus is kept and found devices keep their pointer register.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param[out] foundMask Bit i is set if device at address 0x40 + i was found, may be NULL
+*
+* @returns 0 on success or an error code
+*
+* @note Device is added with weight 1, its index is the order in which it was found.
+*/
+int tmp006_scanBus(TMP006_Bus *bus, uint8_t *foundMask);
+
+/**
+* @brief Configure one or all devices on the bus.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param index Index of device, or TMP006_BUS_MAX_DEVICES for all devices
+* @param cfg Pointer to configuration, see tmp006_configure()
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_busConfigure(TMP006_Bus *bus, uint8_t index, const TMP006_Config *cfg);
+
+/**
+* @brief Read samples of all devices in round-robin order.
+*
+* Sweep starts with the device following the first one of previous sweep,
+* so no device is always last when the bus is slow.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param[out] samples Array of at least deviceCount samples, indexed by device index
+* @param checkReady If true, only devices with finished conversion are read
+* @param[out] readyMask Bit i is set if samples[i] was updated
+*
+* @returns 0 on success or an error code of the first failed device
+*/
+int tmp006_busSampleAll(TMP006_Bus *bus, TMP006_Sample *samples, bool checkReady, uint8_t *readyMask);
+
+/**
+* @brief Read samples of up to maxDevices devices chosen by priority.
+*
+* Devices are chosen by smooth weighted round-robin, so over time device is read
+* proportionally to its weight and reads of one device are spread evenly.
+* Device is read at most once per call, so device whose share of maxDevices reads
+* is one or more is read in every call and the rest are shared by the others.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param[out] samples Array of at least deviceCount samples, indexed by device index
+* @param maxDevices Number of devices to read in this call
+* @param[out] readyMask Bit i is set if samples[i] was updated
+*
+* @returns 0 on success or an error code of the first failed device
+*/
+int tmp006_busSamplePriority(TMP006_Bus *bus, TMP006_Sample *samples, uint8_t maxDevices, uint8_t *readyMask);
+
+/** @brief Number of transactions needed for sweep of full bus */
+#define TMP006_BUS_SWEEP_LENGTH     (2 * TMP006_BUS_MAX_DEVICES)
+
+/**
+* @brief Prepare transactions that read voltage and temperature of all devices.
+*
+* Transactions can be passed at once to a queueing transport such as platform_i2cSubmit(),
+* so the whole sweep is performed without gaps.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param[out] txns Array of TMP006_BUS_SWEEP_LENGTH transactions
+* @param[out] count Number of prepared transactions
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_busPrepareSweep(TMP006_Bus *bus, TMP006_Transaction *txns, uint16_t *count);
+
+/**
+* @brief Decode samples from finished sweep.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param[in] txns Transactions prepared by tmp006_busPrepareSweep() and finished
+* @param[out] samples Array of at least deviceCount samples, indexed by device index
+* @param[out] readyMask Bit i is set if samples[i] was updated
+*
+* @returns 0 on success or an error code of the first failed transaction
+*/
+int tmp006_busSweepResult(TMP006_Bus *bus, const TMP006_Transaction *txns, TMP006_Sample *samples, uint8_t *readyMask);
+
+/**
+* @brief Note falling edges of DRDY pins, called from port interrupt.
+*
+* Samples are read later by tmp006_busSamplePending(), bus isn't used in interrupt.
+* Bit i is DRDY pin of device at address 0x40 + i, as in foundMask of tmp006_scanBus(),
+* so pins keep matching when a sensor is missing. Bits of addresses which aren't on
+* the bus are ignored.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param readyMask Bit i is set if DRDY of device at address 0x40 + i fell, see platform_configureDrdyPins()
+*/
+void tmp006_busDrdy(TMP006_Bus *bus, uint8_t readyMask);
+
+/**
+* @brief Read samples of devices whose DRDY fell since the previous call.
+*
+* Edge means result is ready, so DRDY bit isn't checked. Edges which come
+* during the call are left for the next one.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param[out] samples Array of at least deviceCount samples, indexed by device index
+* @param[out] readyMask Bit i is set if samples[i] was updated
+*
+* @returns 0 on success or an error code of the first failed device
+*/
+int tmp006_busSamplePending(TMP006_Bus *bus, TMP006_Sample *samples, uint8_t *readyMask);
+
+/**
+* @brief Get device structure of one device for use with other driver functions.
+*
+* @param bus Pointer to TMP006 bus structure
+* @param index Index of device
+*
+* @returns pointer to shared device structure loaded with state of device,
+* NULL if index is invalid
+*
+* @note Returned structure is valid until the next call of any tmp006_bus function,
+* call tmp006_busRelease() when done so cached state of device is kept.
+*/
+TMP006_Device *tmp006_busAcquire(TMP006_Bus *bus, uint8_t index);
+
+/**
+* @brief Save state of device acquired by tmp006_busAcquire().
+*
+* @param bus Pointer to TMP006 bus structure
+* @param index Index of device passed to tmp006_busAcquire()
+*/
+void tmp006_busRelease(TMP006_Bus *bus, uint8_t index);
+
+/**
+* @brief Change SCL rate of the bus, see tmp006_setI2cSpeed().
+*
+* @param bus Pointer to TMP006 bus structure
+* @param speedHz Requested rate, TMP006_I2C_STANDARD_MODE or TMP006_I2C_FAST_MODE
+* @param achievedHz Pointer where achieved rate will be stored, may be NULL
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_busSetSpeed(TMP006_Bus *bus, uint32_t speedHz, uint32_t *achievedHz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TMP006_BUS_H
@@ -0,0 +1,112 @@
+/**
+* @file tmp006_ring.c
+* @brief Lock-free ring of samples between one producer and one consumer
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_ring.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+/**@{ Access to index written by the other side */
+#if defined(__GNUC__)
+#define RING_LOAD_ACQUIRE(index)            __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(index, value)    __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#else
+//enough on single core where the other side is an interrupt
+#define RING_LOAD_ACQUIRE(index)            (*(volatile const uint32_t *)&(index))
+#define RING_STORE_RELEASE(index, value)    (*(volatile uint32_t *)&(index) = (value))
+#endif
+/**@}*/
+
+int tmp006_ringInit(TMP006_SampleRing *ring, TMP006_Sample *buffer, uint32_t capacity)
+{
+    if ((ring == NULL) || (buffer == NULL) || (capacity < 2) || ((capacity & (capacity - 1)) != 0))
+    {
+        return -EINVAL;
+    }
+
+    ring->buffer = buffer;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->highWater = 0;
+
+    return 0;
+}
+
+bool tmp006_ringPush(TMP006_SampleRing *ring, const TMP006_Sample *sample)
+{
+    const uint32_t head = ring->head;
+    const uint32_t count = head - RING_LOAD_ACQUIRE(ring->tail);
+
+    if (count > ring->mask)
+    {
+        ring->dropped++;
+        return false;
+    }
+
+    ring->buffer[head & ring->mask] = *sample;
+    if (count >= ring->highWater)
+    {
+        ring->highWater = count + 1;
+    }
+
+    //sample is written before consumer can see it
+    RING_STORE_RELEASE(ring->head, head + 1);
+
+    return true;
+}
+
+uint32_t tmp006_ringCount(const TMP006_SampleRing *ring)
+{
+    return RING_LOAD_ACQUIRE(ring->head) - RING_LOAD_ACQUIRE(ring->tail);
+}
+
+uint32_t tmp006_ringPeek(const TMP006_SampleRing *ring, const TMP006_Sample **span)
+{
+    const uint32_t tail = ring->tail;
+    const uint32_t count = RING_LOAD_ACQUIRE(ring->head) - tail;
+    const uint32_t first = tail & ring->mask;
+    const uint32_t toEnd = ring->mask + 1 - first;
+
+    *span = &ring->buffer[first];
+
+    return (count < toEnd) ? count : toEnd;
+}
+
+void tmp006_ringRelease(TMP006_SampleRing *ring, uint32_t count)
+{
+    //samples are read before producer can overwrite them
+    RING_STORE_RELEASE(ring->tail, ring->tail + count);
+}
+
+uint32_t tmp006_ringDrain(TMP006_SampleRing *ring, TMP006_Sample *samples, uint32_t maxCount)
+{
+    uint32_t copied = 0;
+
+    //second span starts at the beginning of buffer
+    for (uint8_t i = 0; (i < 2) && (copied < maxCount); i++)
+    {
+        const TMP006_Sample *span;
+        uint32_t count = tmp006_ringPeek(ring, &span);
+        if (count == 0)
+        {
+            break;
+        }
+        if (count > (maxCount - copied))
+        {
+            count = maxCount - copied;
+        }
+
+        memcpy(&samples[copied], span, count * sizeof(*span));
+        tmp006_ringRelease(ring, count);
+        copied += count;
+    }
+
+    return copied;
+}
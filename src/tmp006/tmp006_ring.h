@@ -0,0 +1,109 @@
+/**
+* @file tmp006_ring.h
+* @brief Lock-free ring of samples between one producer and one consumer
+*
+* Producer is typically the completion of a sample read started at DRDY edge,
+* running in interrupt context, and consumer is the main loop. Each index is
+* written by one side only and published with release semantics, so no lock
+* or disabled interrupts are needed.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TMP006_RING_H
+#define  TMP006_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tmp006.h"
+
+/**
+* @brief Ring of samples
+*
+* Indexes run freely and wrap at 2^32, position in buffer is index & mask.
+*/
+typedef struct TMP006_SampleRing
+{
+    TMP006_Sample *buffer;    /**< Storage, number of samples is power of two */
+    uint32_t       mask;      /**< Capacity - 1 */
+    uint32_t       head;      /**< Number of pushed samples, written by producer */
+    uint32_t       tail;      /**< Number of consumed samples, written by consumer */
+    uint32_t       dropped;   /**< Samples not stored because ring was full, written by producer */
+    uint32_t       highWater; /**< Most samples in ring at once, written by producer */
+} TMP006_SampleRing;
+
+/**
+* @brief Initialize empty ring.
+*
+* @param ring Pointer to ring
+* @param buffer Storage for samples, must be valid while ring is used
+* @param capacity Number of samples in buffer, power of two, at least 2
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_ringInit(TMP006_SampleRing *ring, TMP006_Sample *buffer, uint32_t capacity);
+
+/**
+* @brief Store sample, called only by producer.
+*
+* If ring is full sample is dropped and counted, samples already in ring are kept.
+*
+* @param ring Pointer to ring
+* @param sample Sample to copy into ring
+*
+* @returns true if sample is stored, false if it was dropped
+*/
+bool tmp006_ringPush(TMP006_SampleRing *ring, const TMP006_Sample *sample);
+
+/**
+* @brief Get number of samples waiting in ring.
+*
+* @param ring Pointer to ring
+*
+* @returns number of samples
+*/
+uint32_t tmp006_ringCount(const TMP006_SampleRing *ring);
+
+/**
+* @brief Get the oldest samples which are contiguous in buffer, called only by consumer.
+*
+* Samples stay in ring until tmp006_ringRelease() is called, so they can be
+* processed in place.
+*
+* @param ring Pointer to ring
+* @param span Set to the oldest sample
+*
+* @returns number of contiguous samples at span, 0 if ring is empty
+*/
+uint32_t tmp006_ringPeek(const TMP006_SampleRing *ring, const TMP006_Sample **span);
+
+/**
+* @brief Remove the oldest samples, called only by consumer.
+*
+* @param ring Pointer to ring
+* @param count Number of samples, at most tmp006_ringCount()
+*/
+void tmp006_ringRelease(TMP006_SampleRing *ring, uint32_t count);
+
+/**
+* @brief Copy the oldest samples out of ring and remove them, called only by consumer.
+*
+* At most two contiguous copies are made, one before and one after the end of buffer.
+*
+* @param ring Pointer to ring
+* @param samples Array for samples
+* @param maxCount Size of array
+*
+* @returns number of copied samples
+*/
+uint32_t tmp006_ringDrain(TMP006_SampleRing *ring, TMP006_Sample *samples, uint32_t maxCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TMP006_RING_H
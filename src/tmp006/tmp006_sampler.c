@@ -0,0 +1,299 @@
+/**
+* @file tmp006_sampler.c
+* @brief Event driven sampling of one TMP006 device
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_sampler.h"
+
+#include <errno.h>
+#include <stddef.h>
+
+/*
+* Helper macro for parametar checking
+*/
+#define TMP006_CHECK_PARAM(expr) \
+    do                           \
+    {                            \
+        if (expr)                \
+        {                        \
+            return -EINVAL;      \
+        }                        \
+    } while (0)
+
+/** @brief One timer tick in predictive mode, times there have 8 fractional bits */
+#define TICK    256
+
+/** @brief Time is compared as difference, so counters can wrap */
+#define IS_BEFORE(a, b)     ((int32_t)((a) - (b)) < 0)
+
+/**
+* @brief Poll for the next predicted end of conversion
+*
+* Predicted end is between two ticks. Normal poll is in the tick after it, probe
+* poll in the tick before it.
+*/
+static void schedulePoll(TMP006_Sampler *sampler)
+{
+    sampler->nextPoll = (sampler->probe == 0) ? (sampler->predicted - TICK) : sampler->predicted;
+}
+
+/**
+* @brief Learn from result of poll in predictive mode
+*/
+static void predict(TMP006_Sampler *sampler, bool ready)
+{
+    const uint32_t now = sampler->pollTick;
+    const uint32_t nominal = sampler->periodTicks * TICK;
+    //coarse search finds some end within period, with 16 polls
+    const uint32_t step = (sampler->period / 16 > TICK) ? (sampler->period / 16) : TICK;
+
+    if (!ready)
+    {
+        sampler->lastNotReady = now;
+        if ((sampler->phase == TMP006_SAMPLER_SEARCH) ||
+            !IS_BEFORE(now, sampler->predicted + (sampler->period / 8)))
+        {
+            //end is far from prediction, conversion was restarted
+            sampler->phase = TMP006_SAMPLER_SEARCH;
+            sampler->nextPoll = now + step;
+        }
+        else
+        {
+            sampler->nextPoll = now + TICK;
+        }
+        return;
+    }
+
+    //end of conversion is between the last poll without result and this one
+    const bool bracketed = ((now - sampler->lastNotReady) == TICK);
+
+    switch (sampler->phase)
+    {
+        case TMP006_SAMPLER_SEARCH:
+        {
+            //next end is searched tick by tick from the beginning of coarse bracket
+            sampler->phase = TMP006_SAMPLER_ACQUIRE;
+            sampler->predicted = now - step + sampler->period;
+            sampler->nextPoll = sampler->predicted - TICK;
+            break;
+        }
+        case TMP006_SAMPLER_ACQUIRE:
+        {
+            if (!bracketed)
+            {
+                //end was before the first poll, search from a step earlier
+                sampler->predicted = now - step + sampler->period;
+                sampler->nextPoll = sampler->predicted - TICK;
+                break;
+            }
+            sampler->phase = TMP006_SAMPLER_TRACK;
+            sampler->predicted = now - (TICK / 2) + sampler->period;
+            sampler->probe = TMP006_SAMPLER_PROBE_INTERVAL;
+            schedulePoll(sampler);
+            break;
+        }
+        default:
+        {
+            //result at the first normal poll tells only that prediction wasn't late
+            if (bracketed || (sampler->probe == 0))
+            {
+                const uint32_t end = bracketed ? (now - (TICK / 2)) : (now - TICK);
+                const int32_t error = (int32_t)(end - sampler->predicted);
+
+                //period follows oscillator drift slowly, phase is corrected faster
+                int32_t period = (int32_t)sampler->period + (error / 8);
+                if (period < (int32_t)(nominal - (nominal / 8)))
+                {
+                    period = (int32_t)(nominal - (nominal / 8));
+                }
+                if (period > (int32_t)(nominal + (nominal / 8)))
+                {
+                    period = (int32_t)(nominal + (nominal / 8));
+                }
+                sampler->period = (uint32_t)period;
+                sampler->predicted += (uint32_t)(error / 2);
+            }
+
+            sampler->probe = (sampler->probe == 0) ? TMP006_SAMPLER_PROBE_INTERVAL : (sampler->probe - 1);
+            sampler->predicted += sampler->period;
+            schedulePoll(sampler);
+            break;
+        }
+    }
+}
+
+/**
+* @brief Completion of sample read, possibly in interrupt context
+*/
+static void sampleDone(TMP006_SampleRequest *req)
+{
+    TMP006_Sampler *sampler = (TMP006_Sampler *)req->context;
+
+    if (sampler->mode == TMP006_SAMPLER_PREDICTIVE)
+    {
+        //failed poll is repeated in the next tick
+        if ((req->status == 0) || (req->status == -EAGAIN))
+        {
+            predict(sampler, req->status == 0);
+        }
+        else
+        {
+            sampler->nextPoll = sampler->pollTick + TICK;
+        }
+    }
+
+    if (req->status == -EAGAIN)
+    {
+        sampler->notReady++;
+        return;
+    }
+
+    if (req->status != 0)
+    {
+        sampler->errors++;
+        //result is still unread, so DRDY won't fall again
+        sampler->retry = (sampler->mode == TMP006_SAMPLER_DRDY);
+        return;
+    }
+
+    if (sampler->dev->getTime != NULL)
+    {
+        const uint32_t latency = sampler->sample.timestamp - sampler->triggerTime;
+        if (latency > sampler->maxLatency)
+        {
+            sampler->maxLatency = latency;
+        }
+    }
+
+    sampler->samples++;
+    if (sampler->ring != NULL)
+    {
+        tmp006_ringPush(sampler->ring, &sampler->sample);
+    }
+    if (sampler->onSample != NULL)
+    {
+        sampler->onSample(sampler, &sampler->sample);
+    }
+}
+
+/**
+* @brief Start sample read unless previous one is still running
+*/
+static void startRead(TMP006_Sampler *sampler, bool checkReady)
+{
+    if (sampler->req.status == TMP006_TXN_PENDING)
+    {
+        sampler->missed++;
+        return;
+    }
+
+    if (checkReady)
+    {
+        sampler->polls++;
+    }
+    sampler->retry = false;
+    sampler->pollTick = sampler->ticks * TICK;
+    sampler->triggerTime = (sampler->dev->getTime != NULL) ? sampler->dev->getTime() : 0;
+    tmp006_readSampleAsync(sampler->dev, &sampler->sample, checkReady, &sampler->req, sampleDone, sampler);
+}
+
+int tmp006_samplerInit(TMP006_Sampler *sampler, TMP006_Device *dev, enum TMP006_SamplerMode mode,
+                       uint32_t periodTicks, TMP006_SampleRing *ring,
+                       void (*onSample)(TMP006_Sampler *sampler, const TMP006_Sample *sample), void *context)
+{
+    TMP006_CHECK_PARAM((sampler == NULL) || (dev == NULL) || (mode > TMP006_SAMPLER_PREDICTIVE));
+    TMP006_CHECK_PARAM((mode != TMP006_SAMPLER_DRDY) && (periodTicks == 0));
+
+    sampler->dev = dev;
+    sampler->mode = mode;
+    sampler->periodTicks = periodTicks;
+    sampler->ring = ring;
+    sampler->onSample = onSample;
+    sampler->context = context;
+    sampler->running = false;
+    sampler->retry = false;
+    sampler->req.status = 0;
+
+    return 0;
+}
+
+int tmp006_samplerStart(TMP006_Sampler *sampler)
+{
+    TMP006_CHECK_PARAM(sampler == NULL);
+
+    sampler->samples = 0;
+    sampler->polls = 0;
+    sampler->missed = 0;
+    sampler->notReady = 0;
+    sampler->errors = 0;
+    sampler->maxLatency = 0;
+    sampler->countdown = sampler->periodTicks;
+    sampler->ticks = 0;
+    sampler->phase = TMP006_SAMPLER_SEARCH;
+    sampler->period = sampler->periodTicks * TICK;
+    sampler->predicted = 0;
+    sampler->nextPoll = 0;
+    sampler->lastNotReady = 0 - (2 * TICK);
+    sampler->probe = 0;
+    sampler->running = true;
+
+    if (sampler->mode == TMP006_SAMPLER_DRDY)
+    {
+        startRead(sampler, true);
+    }
+
+    return 0;
+}
+
+void tmp006_samplerStop(TMP006_Sampler *sampler)
+{
+    sampler->running = false;
+
+    while (sampler->req.status == TMP006_TXN_PENDING)
+    {
+    }
+}
+
+void tmp006_samplerDrdy(TMP006_Sampler *sampler)
+{
+    if (sampler->running && (sampler->mode == TMP006_SAMPLER_DRDY))
+    {
+        //edge means result is ready, there is no need to check it
+        startRead(sampler, false);
+    }
+}
+
+void tmp006_samplerTick(TMP006_Sampler *sampler)
+{
+    if (!sampler->running || (sampler->mode == TMP006_SAMPLER_DRDY))
+    {
+        return;
+    }
+
+    sampler->ticks++;
+    if (sampler->mode == TMP006_SAMPLER_PREDICTIVE)
+    {
+        //read in progress is not a missed event, poll waits for it
+        if ((sampler->req.status != TMP006_TXN_PENDING) && !IS_BEFORE(sampler->ticks * TICK, sampler->nextPoll))
+        {
+            startRead(sampler, true);
+        }
+        return;
+    }
+
+    if (--sampler->countdown == 0)
+    {
+        sampler->countdown = sampler->periodTicks;
+        startRead(sampler, sampler->mode == TMP006_SAMPLER_POLLED);
+    }
+}
+
+void tmp006_samplerService(TMP006_Sampler *sampler)
+{
+    if (sampler->running && sampler->retry)
+    {
+        startRead(sampler, true);
+    }
+}
@@ -0,0 +1,162 @@
+/**
+* @file tmp006_sampler.h
+* @brief Event driven sampling of one TMP006 device
+*
+* Sampler starts asynchronous sample reads from interrupt handlers: at DRDY
+* edge, or every period of a timer. Finished samples are delivered to callback
+* and/or pushed into ring, so between events the core has nothing to do and
+* can sleep, see platform_waitForEvent().
+*
+* Device transport needs i2cStart() for reads to run in background, with
+* blocking transport sample is read inside the interrupt handler.
+*
+* Predictive mode is for boards without DRDY pin. It starts with the nominal
+* period, finds the end of a conversion by polling, and then predicts the next
+* one. The first poll is made in the tick after predicted end, so usually one
+* poll reads the sample. Every TMP006_SAMPLER_PROBE_INTERVAL samples it polls one
+* tick earlier, so the end is bracketed within one tick. Bracketed ends correct
+* the phase and the period, which follows the drift of the sensor oscillator.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TMP006_SAMPLER_H
+#define  TMP006_SAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tmp006.h"
+#include "tmp006_ring.h"
+
+/**
+* @brief How sampler finds out that a new result is ready
+*/
+enum TMP006_SamplerMode
+{
+    TMP006_SAMPLER_DRDY,   /**< Sample is read at falling edge of DRDY pin, the lowest latency */
+    TMP006_SAMPLER_TIMER,  /**< Sample is read every period without checking DRDY, no pin needed */
+    TMP006_SAMPLER_POLLED, /**< DRDY bit is read every period, sample is read when it's set */
+    TMP006_SAMPLER_PREDICTIVE /**< DRDY bit is read only around predicted end of conversion, see below */
+};
+
+/**
+* @brief Phase of predictive mode
+*/
+enum TMP006_SamplerPhase
+{
+    TMP006_SAMPLER_SEARCH,  /**< Phase of conversions is unknown, DRDY is polled in coarse steps */
+    TMP006_SAMPLER_ACQUIRE, /**< End of conversion is searched tick by tick from the coarse result */
+    TMP006_SAMPLER_TRACK    /**< End of conversion is predicted, one or two polls per sample */
+};
+
+/** @brief Every this many samples predictive mode polls just before predicted end, to measure drift */
+#define TMP006_SAMPLER_PROBE_INTERVAL   4
+
+struct TMP006_Sampler;
+
+/**
+* @brief Sampler structure
+*/
+typedef struct TMP006_Sampler
+{
+    TMP006_Device          *dev;         /**< Sampled device */
+    enum TMP006_SamplerMode mode;        /**< Source of reads */
+    uint32_t                periodTicks; /**< Timer ticks between reads, nominal conversion period in predictive mode */
+    TMP006_SampleRing      *ring;        /**< Optional queue samples are pushed into */
+    void (*onSample)(struct TMP006_Sampler *sampler, const TMP006_Sample *sample); /**< Optional, called from completion context */
+    void                   *context;     /**< User data for onSample */
+
+    volatile bool           running;     /**< Sampler reacts to events */
+    volatile bool           retry;       /**< Read at DRDY edge failed, result is still unread */
+    uint32_t                countdown;   /**< Ticks until next read */
+    uint32_t                triggerTime; /**< Device time of event which started current read */
+    TMP006_Sample           sample;      /**< Sample being read */
+    TMP006_SampleRequest    req;         /**< Request of sample being read */
+
+    /* times of predictive mode are in ticks with 8 fractional bits */
+    uint32_t                ticks;       /**< Timer ticks since start */
+    uint32_t                pollTick;    /**< Time when current read was started */
+    uint32_t                nextPoll;    /**< Time of next poll, it is made in the first tick after it */
+    uint32_t                lastNotReady; /**< Time of the last poll which found no result */
+    uint32_t                predicted;   /**< Predicted end of next conversion */
+    uint32_t                period;      /**< Learned conversion period */
+    uint8_t                 phase;       /**< Phase of predictive mode, enum TMP006_SamplerPhase */
+    uint8_t                 probe;       /**< Samples until next probe poll */
+
+    volatile uint32_t       samples;     /**< Delivered samples */
+    volatile uint32_t       polls;       /**< Reads of DRDY bit, the ones followed by sample read included */
+    volatile uint32_t       missed;      /**< Events which came while previous read was in progress */
+    volatile uint32_t       notReady;    /**< Polls which found no new result */
+    volatile uint32_t       errors;      /**< Failed reads */
+    volatile uint32_t       maxLatency;  /**< Longest time from event to data, in units of device getTime() */
+} TMP006_Sampler;
+
+/**
+* @brief Initialize stopped sampler.
+*
+* @param sampler Pointer to sampler structure
+* @param dev Pointer to initialized device, it must not be used by others while sampler runs
+* @param mode Source of reads
+* @param periodTicks Timer ticks between reads, used in timer and polled mode,
+* in predictive mode nominal period, see tmp006_conversionPeriodMs()
+* @param ring Queue for samples, can be NULL
+* @param onSample Function called with every sample from completion context, can be NULL
+* @param context User data for onSample
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_samplerInit(TMP006_Sampler *sampler, TMP006_Device *dev, enum TMP006_SamplerMode mode,
+                       uint32_t periodTicks, TMP006_SampleRing *ring,
+                       void (*onSample)(TMP006_Sampler *sampler, const TMP006_Sample *sample), void *context);
+
+/**
+* @brief Clear counters and start reacting to events.
+*
+* In DRDY mode a result which is already waiting is read at once, otherwise DRDY pin
+* stays low and there would be no edge.
+*
+* @param sampler Pointer to sampler structure
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_samplerStart(TMP006_Sampler *sampler);
+
+/**
+* @brief Stop reacting to events and wait for read in progress.
+*
+* @param sampler Pointer to sampler structure
+*/
+void tmp006_samplerStop(TMP006_Sampler *sampler);
+
+/**
+* @brief Event of DRDY pin, called from its falling edge interrupt.
+*
+* @param sampler Pointer to sampler structure
+*/
+void tmp006_samplerDrdy(TMP006_Sampler *sampler);
+
+/**
+* @brief Event of periodic timer, called from its interrupt.
+*
+* @param sampler Pointer to sampler structure
+*/
+void tmp006_samplerTick(TMP006_Sampler *sampler);
+
+/**
+* @brief Work done outside of interrupts, called by consumer after it wakes up.
+*
+* Read which failed at DRDY edge is started again.
+*
+* @param sampler Pointer to sampler structure
+*/
+void tmp006_samplerService(TMP006_Sampler *sampler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TMP006_SAMPLER_H
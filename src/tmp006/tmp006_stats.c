@@ -0,0 +1,438 @@
+/**
+* @file tmp006_stats.c
+* @brief Optional instrumentation of TMP006 driver calls and bus transactions
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_stats.h"
+
+#ifdef TMP006_STATS
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Counter update safe against interrupts and other threads */
+#define STATS_ADD(counter, value)   ((void)__atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED))
+#define STATS_LOAD(counter)         __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+
+/** @brief Prefix of every line of dump */
+#define STATS_PREFIX        "tmp006 stats "
+
+static TMP006_Stats stats;
+
+static uint32_t (*clockCycles)(void);
+static uint64_t (*clockToNs)(uint32_t cycles);
+
+/** @brief Last failed transaction as returned by transactionKey(), 0 if the last one succeeded */
+static uint32_t lastFailed;
+
+/** @brief Original transport of wrapped devices */
+static int (*transportRead)(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length);
+static int (*transportWrite)(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length);
+static int (*transportReadCurrent)(uint8_t addr, uint8_t *data, uint16_t length);
+
+/** @brief Names used in dump, indexed by enum TMP006_StatsCall */
+static const char *const callNames[TMP006_STATS_CALL_COUNT] = {
+    "read", "write", "readTemp", "readVoltage", "readSample", "isResultReady",
+    "updateConfig", "configure", "reset", "syncConfig", "transport"
+};
+
+/**
+* @brief Bytes on the bus of transaction with 2 data bytes, address bytes included
+*/
+static uint32_t transactionBytes(uint8_t type)
+{
+    switch (type)
+    {
+        case TMP006_TXN_READ:
+            return 5; //address, register, repeated start address, 2 data bytes
+        case TMP006_TXN_READ_CURRENT:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+/**
+* @brief Identify transaction, repeated one has the same key
+*
+* Read of the same register is the same transaction even if its pointer write is skipped.
+*/
+static uint32_t transactionKey(const TMP006_Transaction *txn)
+{
+    const uint32_t write = (txn->type == TMP006_TXN_WRITE) ? 1 : 0;
+
+    return (1u << 24) | ((uint32_t)txn->addr << 16) | ((uint32_t)txn->reg << 8) | write;
+}
+
+/**
+* @brief Latency bucket, bucket i holds [2^(i-1), 2^i) ns
+*/
+static uint8_t latencyBucket(uint32_t ns)
+{
+    uint8_t bucket = 0;
+
+    while ((ns != 0) && (bucket < (TMP006_STATS_BUCKETS - 1)))
+    {
+        ns >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/**
+* @brief Add one finished call to statistics
+*/
+static void recordCall(uint8_t call, uint32_t startCycles, uint32_t transactions, uint32_t bytes, uint32_t errors)
+{
+    TMP006_CallStats *entry = &stats.call[call];
+
+    STATS_ADD(entry->calls, 1);
+    STATS_ADD(entry->transactions, transactions);
+    STATS_ADD(entry->bytes, bytes);
+    STATS_ADD(entry->errors, errors);
+
+    if (clockCycles == NULL)
+    {
+        return;
+    }
+
+    const uint64_t ns = clockToNs(clockCycles() - startCycles);
+    const uint32_t latency = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+    STATS_ADD(entry->histogram[latencyBucket(latency)], 1);
+
+    uint32_t max = STATS_LOAD(entry->maxNs);
+    while ((latency > max) &&
+           !__atomic_compare_exchange_n(&entry->maxNs, &max, latency, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+void tmp006_statsSetClock(uint32_t (*cycles)(void), uint64_t (*cyclesToNs)(uint32_t cycles))
+{
+    //both are needed, latency isn't recorded with one of them
+    clockToNs = cyclesToNs;
+    clockCycles = (cyclesToNs != NULL) ? cycles : NULL;
+}
+
+TMP006_StatsSpan tmp006_statsBegin(uint8_t call)
+{
+    TMP006_StatsSpan span = {
+        .call = call,
+        .startCycles = (clockCycles != NULL) ? clockCycles() : 0,
+        .transactions = STATS_LOAD(stats.transactions),
+        .bytes = STATS_LOAD(stats.bytes),
+        .errors = STATS_LOAD(stats.errors)
+    };
+
+    return span;
+}
+
+void tmp006_statsEnd(TMP006_StatsSpan *span)
+{
+    //bus traffic of the call is what was added to the totals meanwhile
+    recordCall(span->call, span->startCycles,
+               STATS_LOAD(stats.transactions) - span->transactions,
+               STATS_LOAD(stats.bytes) - span->bytes,
+               STATS_LOAD(stats.errors) - span->errors);
+}
+
+void tmp006_statsTransaction(const TMP006_Transaction *txn, int status)
+{
+    const uint32_t key = transactionKey(txn);
+
+    STATS_ADD(stats.transactions, 1);
+    STATS_ADD(stats.bytes, transactionBytes(txn->type));
+    if (status != 0)
+    {
+        STATS_ADD(stats.errors, 1);
+    }
+
+    if (__atomic_exchange_n(&lastFailed, (status != 0) ? key : 0, __ATOMIC_RELAXED) == key)
+    {
+        STATS_ADD(stats.retries, 1);
+    }
+}
+
+/**
+* @brief Measured i2cRead of wrapped device
+*/
+static int statsI2cRead(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    const uint32_t start = (clockCycles != NULL) ? clockCycles() : 0;
+    const int status = transportRead(addr, reg, data, length);
+
+    recordCall(TMP006_STATS_TRANSPORT, start, 1, 3u + length, (status != 0) ? 1 : 0);
+
+    return status;
+}
+
+/**
+* @brief Measured i2cWrite of wrapped device
+*/
+static int statsI2cWrite(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t length)
+{
+    const uint32_t start = (clockCycles != NULL) ? clockCycles() : 0;
+    const int status = transportWrite(addr, reg, data, length);
+
+    recordCall(TMP006_STATS_TRANSPORT, start, 1, 2u + length, (status != 0) ? 1 : 0);
+
+    return status;
+}
+
+/**
+* @brief Measured i2cReadCurrent of wrapped device
+*/
+static int statsI2cReadCurrent(uint8_t addr, uint8_t *data, uint16_t length)
+{
+    const uint32_t start = (clockCycles != NULL) ? clockCycles() : 0;
+    const int status = transportReadCurrent(addr, data, length);
+
+    recordCall(TMP006_STATS_TRANSPORT, start, 1, 1u + length, (status != 0) ? 1 : 0);
+
+    return status;
+}
+
+int tmp006_statsWrapTransport(TMP006_Device *dev)
+{
+    if ((dev == NULL) || (dev->i2cRead == NULL) || (dev->i2cWrite == NULL))
+    {
+        return -EINVAL;
+    }
+
+    if (dev->i2cRead == statsI2cRead)
+    {
+        return 0; //already wrapped
+    }
+
+    if ((transportRead != NULL) &&
+        ((transportRead != dev->i2cRead) || (transportWrite != dev->i2cWrite) ||
+         ((dev->i2cReadCurrent != NULL) && (transportReadCurrent != dev->i2cReadCurrent))))
+    {
+        return -EBUSY; //other transport is wrapped
+    }
+
+    transportRead = dev->i2cRead;
+    transportWrite = dev->i2cWrite;
+    if (dev->i2cReadCurrent != NULL)
+    {
+        transportReadCurrent = dev->i2cReadCurrent;
+        dev->i2cReadCurrent = statsI2cReadCurrent;
+    }
+    dev->i2cRead = statsI2cRead;
+    dev->i2cWrite = statsI2cWrite;
+
+    return 0;
+}
+
+void tmp006_statsReset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    lastFailed = 0;
+}
+
+const TMP006_Stats *tmp006_statsGet(void)
+{
+    return &stats;
+}
+
+const char *tmp006_statsCallName(uint8_t call)
+{
+    return (call < TMP006_STATS_CALL_COUNT) ? callNames[call] : "";
+}
+
+uint32_t tmp006_statsPercentile(const TMP006_CallStats *callStats, uint8_t percent)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < TMP006_STATS_BUCKETS; i++)
+    {
+        total += callStats->histogram[i];
+    }
+
+    if ((total == 0) || (percent == 0))
+    {
+        return 0;
+    }
+
+    //rank of the call, rounded up
+    const uint32_t rank = (uint32_t)(((uint64_t)total * ((percent > 100) ? 100 : percent) + 99) / 100);
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < (TMP006_STATS_BUCKETS - 1); i++)
+    {
+        count += callStats->histogram[i];
+        if (count >= rank)
+        {
+            return ((1u << i) < callStats->maxNs) ? (1u << i) : callStats->maxNs;
+        }
+    }
+
+    //the last bucket isn't bounded
+    return callStats->maxNs;
+}
+
+/**
+* @brief Append text to line
+*/
+static char *appendText(char *pos, const char *text)
+{
+    while (*text != '\0')
+    {
+        *pos++ = *text++;
+    }
+    *pos = '\0';
+
+    return pos;
+}
+
+/**
+* @brief Append space and decimal number to line
+*/
+static char *appendNumber(char *pos, uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    *pos++ = ' ';
+    while (count > 0)
+    {
+        *pos++ = digits[--count];
+    }
+    *pos = '\0';
+
+    return pos;
+}
+
+void tmp006_statsDump(void (*print)(const char *line))
+{
+    //prefix, name and 21 numbers of at most 10 digits
+    char line[sizeof(STATS_PREFIX) + 20 + (TMP006_STATS_BUCKETS + 5) * 11 + 2];
+
+    if (print == NULL)
+    {
+        return;
+    }
+
+    char *pos = appendText(line, STATS_PREFIX "bus");
+    pos = appendNumber(pos, STATS_LOAD(stats.transactions));
+    pos = appendNumber(pos, STATS_LOAD(stats.bytes));
+    pos = appendNumber(pos, STATS_LOAD(stats.errors));
+    pos = appendNumber(pos, STATS_LOAD(stats.retries));
+    appendText(pos, "\n");
+    print(line);
+
+    for (uint8_t call = 0; call < TMP006_STATS_CALL_COUNT; call++)
+    {
+        TMP006_CallStats *entry = &stats.call[call];
+        if (STATS_LOAD(entry->calls) == 0)
+        {
+            continue;
+        }
+
+        pos = appendText(line, STATS_PREFIX "call ");
+        pos = appendText(pos, callNames[call]);
+        pos = appendNumber(pos, STATS_LOAD(entry->calls));
+        pos = appendNumber(pos, STATS_LOAD(entry->transactions));
+        pos = appendNumber(pos, STATS_LOAD(entry->bytes));
+        pos = appendNumber(pos, STATS_LOAD(entry->errors));
+        pos = appendNumber(pos, STATS_LOAD(entry->maxNs));
+        for (uint8_t i = 0; i < TMP006_STATS_BUCKETS; i++)
+        {
+            pos = appendNumber(pos, STATS_LOAD(entry->histogram[i]));
+        }
+        appendText(pos, "\n");
+        print(line);
+    }
+}
+
+/**
+* @brief Read count numbers separated by spaces
+*/
+static bool parseNumbers(const char *text, uint32_t *values, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        char *end;
+        values[i] = (uint32_t)strtoul(text, &end, 10);
+        if (end == text)
+        {
+            return false;
+        }
+        text = end;
+    }
+
+    return true;
+}
+
+bool tmp006_statsParseLine(TMP006_Stats *parsed, const char *line)
+{
+    if ((parsed == NULL) || (line == NULL))
+    {
+        return false;
+    }
+
+    //dump may be mixed with other output on the same console
+    line = strstr(line, STATS_PREFIX);
+    if (line == NULL)
+    {
+        return false;
+    }
+    line += sizeof(STATS_PREFIX) - 1;
+
+    if (strncmp(line, "bus ", 4) == 0)
+    {
+        uint32_t values[4];
+        if (!parseNumbers(line + 4, values, 4))
+        {
+            return false;
+        }
+        parsed->transactions = values[0];
+        parsed->bytes = values[1];
+        parsed->errors = values[2];
+        parsed->retries = values[3];
+        return true;
+    }
+
+    if (strncmp(line, "call ", 5) != 0)
+    {
+        return false;
+    }
+    line += 5;
+
+    for (uint8_t call = 0; call < TMP006_STATS_CALL_COUNT; call++)
+    {
+        const size_t length = strlen(callNames[call]);
+        if ((strncmp(line, callNames[call], length) != 0) || (line[length] != ' '))
+        {
+            continue;
+        }
+
+        uint32_t values[5 + TMP006_STATS_BUCKETS];
+        if (!parseNumbers(line + length, values, 5 + TMP006_STATS_BUCKETS))
+        {
+            return false;
+        }
+
+        TMP006_CallStats *entry = &parsed->call[call];
+        entry->calls = values[0];
+        entry->transactions = values[1];
+        entry->bytes = values[2];
+        entry->errors = values[3];
+        entry->maxNs = values[4];
+        memcpy(entry->histogram, &values[5], sizeof(entry->histogram));
+        return true;
+    }
+
+    return false;
+}
+
+#endif //TMP006_STATS
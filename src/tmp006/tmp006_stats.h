@@ -0,0 +1,194 @@
+/**
+* @file tmp006_stats.h
+* @brief Optional instrumentation of TMP006 driver calls and bus transactions
+*
+* Enabled by defining TMP006_STATS for the whole project. Without it hooks in
+* the driver expand to nothing and functions below are empty inline functions,
+* so instrumentation costs neither code nor time.
+*
+* Counters are updated with atomic operations, so transactions finished in
+* interrupt are counted safely. Memory is fixed, see TMP006_Stats.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TMP006_STATS_H
+#define  TMP006_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tmp006.h"
+
+/** @brief Number of latency buckets, bucket i counts latencies in [2^(i-1), 2^i) ns, the last one all longer */
+#define TMP006_STATS_BUCKETS    24
+
+/**
+* @brief Instrumented driver calls
+*/
+enum TMP006_StatsCall
+{
+    TMP006_STATS_READ = 0,        /**< tmp006_read() */
+    TMP006_STATS_WRITE,           /**< tmp006_write() */
+    TMP006_STATS_READ_TEMP,       /**< tmp006_readTemp() */
+    TMP006_STATS_READ_VOLTAGE,    /**< tmp006_readVoltage() */
+    TMP006_STATS_READ_SAMPLE,     /**< tmp006_readSample() */
+    TMP006_STATS_IS_RESULT_READY, /**< tmp006_isResultReady() */
+    TMP006_STATS_UPDATE_CONFIG,   /**< tmp006_operationMode(), tmp006_configConvRate(), tmp006_drdyPinConfig() */
+    TMP006_STATS_CONFIGURE,       /**< tmp006_configure() */
+    TMP006_STATS_RESET,           /**< tmp006_resetDevice() */
+    TMP006_STATS_SYNC_CONFIG,     /**< tmp006_syncConfig() */
+    TMP006_STATS_TRANSPORT,       /**< Blocking transport functions wrapped by tmp006_statsWrapTransport() */
+    TMP006_STATS_CALL_COUNT
+};
+
+/**
+* @brief Statistics of one driver call
+*/
+typedef struct TMP006_CallStats
+{
+    uint32_t calls;        /**< Number of calls */
+    uint32_t transactions; /**< Bus transactions done during calls */
+    uint32_t bytes;        /**< Bus bytes of those transactions, address bytes included */
+    uint32_t errors;       /**< Failed bus transactions during calls */
+    uint32_t maxNs;        /**< The longest call in nanoseconds */
+    uint32_t histogram[TMP006_STATS_BUCKETS]; /**< Calls per latency bucket */
+} TMP006_CallStats;
+
+/**
+* @brief All statistics
+*/
+typedef struct TMP006_Stats
+{
+    TMP006_CallStats call[TMP006_STATS_CALL_COUNT]; /**< Indexed by enum TMP006_StatsCall */
+    uint32_t transactions; /**< All finished bus transactions */
+    uint32_t bytes;        /**< Bus bytes of all transactions */
+    uint32_t errors;       /**< Failed transactions */
+    uint32_t retries;      /**< Transactions repeated after the same one failed */
+} TMP006_Stats;
+
+/**
+* @brief State of one measured call, used by hooks in the driver
+*/
+typedef struct TMP006_StatsSpan
+{
+    uint8_t  call;
+    uint32_t startCycles;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t errors;
+} TMP006_StatsSpan;
+
+#ifdef TMP006_STATS
+
+#if !defined(__GNUC__)
+#error "TMP006_STATS needs GNU C extensions (cleanup attribute and atomic builtins)"
+#endif
+
+/** @brief Hook at the beginning of instrumented function, the call is recorded when function returns */
+#define TMP006_STATS_CALL(callId) \
+    TMP006_StatsSpan tmp006StatsSpan __attribute__((cleanup(tmp006_statsEnd))) = tmp006_statsBegin(callId)
+
+/** @brief Hook for every finished bus transaction */
+#define TMP006_STATS_TRANSACTION(txn, status)   tmp006_statsTransaction((txn), (status))
+
+/**
+* @brief Set time source used for latency, without it latency isn't recorded.
+*
+* @param cycles Function returning free running counter, e.g. platform_cycles()
+* @param cyclesToNs Function converting difference of counter values to nanoseconds
+*/
+void tmp006_statsSetClock(uint32_t (*cycles)(void), uint64_t (*cyclesToNs)(uint32_t cycles));
+
+/**
+* @brief Replace blocking transport functions of device with measured ones.
+*
+* Original functions are kept in one place, so all wrapped devices must use the
+* same transport. Transactions started with i2cStart() are counted, but their
+* latency isn't measured.
+*
+* @param dev Pointer to the TMP006 device structure
+*
+* @returns 0 on success or an error code
+*/
+int tmp006_statsWrapTransport(TMP006_Device *dev);
+
+/**
+* @brief Clear all statistics.
+*/
+void tmp006_statsReset(void);
+
+/**
+* @brief Get statistics.
+*
+* @returns pointer to statistics, values may change while they are read
+*/
+const TMP006_Stats *tmp006_statsGet(void);
+
+/**
+* @brief Get name of call used in dump.
+*
+* @param call Value of enum TMP006_StatsCall
+*
+* @returns name, empty string if call isn't valid
+*/
+const char *tmp006_statsCallName(uint8_t call);
+
+/**
+* @brief Upper bound of latency bucket where given percentile of calls is.
+*
+* @param callStats Statistics of one call
+* @param percent Percentile, 1 - 100
+*
+* @returns latency in nanoseconds, not above the longest call, 0 if there were no calls
+*/
+uint32_t tmp006_statsPercentile(const TMP006_CallStats *callStats, uint8_t percent);
+
+/**
+* @brief Print statistics line by line, in format read by tmp006_statsParseLine().
+*
+* @param print Function which prints one line, e.g. wrapper of PRINTF
+*/
+void tmp006_statsDump(void (*print)(const char *line));
+
+/**
+* @brief Read one line printed by tmp006_statsDump(), used on host.
+*
+* @param parsed Statistics updated with values from line
+* @param line Line of dump, other lines are ignored
+*
+* @returns true if line was part of dump
+*/
+bool tmp006_statsParseLine(TMP006_Stats *parsed, const char *line);
+
+/** @cond */
+TMP006_StatsSpan tmp006_statsBegin(uint8_t call);
+void tmp006_statsEnd(TMP006_StatsSpan *span);
+void tmp006_statsTransaction(const TMP006_Transaction *txn, int status);
+/** @endcond */
+
+#else
+
+#define TMP006_STATS_CALL(callId)
+#define TMP006_STATS_TRANSACTION(txn, status)   ((void)0)
+
+static inline void tmp006_statsSetClock(uint32_t (*cycles)(void), uint64_t (*cyclesToNs)(uint32_t cycles))
+{
+    (void)cycles;
+    (void)cyclesToNs;
+}
+static inline int tmp006_statsWrapTransport(TMP006_Device *dev) { (void)dev; return 0; }
+static inline void tmp006_statsReset(void) { }
+static inline void tmp006_statsDump(void (*print)(const char *line)) { (void)print; }
+
+#endif //TMP006_STATS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TMP006_STATS_H
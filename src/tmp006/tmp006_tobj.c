@@ -0,0 +1,352 @@
+/**
+* @file tmp006_tobj.c
+* @brief Object temperature calculation for TI TMP006, integer only
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_tobj.h"
+
+#include <errno.h>
+#include <stddef.h>
+
+/*
+* Helper macro for parametar checking
+*/
+#define TMP006_CHECK_PARAM(expr) \
+    do                           \
+    {                            \
+        if (expr)                \
+        {                        \
+            return -EINVAL;      \
+        }                        \
+    } while (0)
+
+/** @brief Largest Tobj^4 (Q4) that can be shifted to Q24 without overflow */
+#define TMP006_TOBJ4_MAX    (INT64_MAX >> 20)
+
+/** @brief Limits of lookup table spacing */
+#define TMP006_TABLE_TSHIFT_MIN     2
+#define TMP006_TABLE_TSHIFT_MAX     13
+#define TMP006_TABLE_VSHIFT_MIN     5
+#define TMP006_TABLE_VSHIFT_MAX     16
+
+/** @brief Subcells of table cell in each axis, in which error bound is checked */
+#define TMP006_TABLE_CHECK_STEPS    4
+
+uint32_t tmp006_root4(uint64_t x)
+{
+    if (x < 2)
+    {
+        return (uint32_t)x;
+    }
+    
+    //initial guess 2^ceil(bits / 4) is always above the root
+    uint32_t bits = 0;
+    for (uint64_t tmp = x; tmp != 0; tmp >>= 1)
+    {
+        bits++;
+    }
+    uint64_t r = (uint64_t)1 << ((bits + 3) / 4);
+    
+    //sequence is decreasing until it reaches floor of the root
+    while (1)
+    {
+        uint64_t next = (3 * r + x / (r * r * r)) / 4;
+        if (next >= r)
+        {
+            break;
+        }
+        r = next;
+    }
+    
+    return (uint32_t)r;
+}
+
+/**
+* @brief Exact calculation of object temperature
+*/
+static int computeExact(const TMP006_Calibration *cal, int16_t voltage, int16_t temperature, int16_t *tobj)
+{
+    //Tdie - Tref, Q5 and its square Q10
+    const int64_t t = (int64_t)temperature - TMP006_TREF;
+    const int64_t t2 = t * t;
+    
+    //S / S0, Q30
+    const int64_t sFactor = ((int64_t)1 << 30) + ((cal->a1 * t) >> 15) + ((cal->a2 * t2) >> 20);
+    if (sFactor <= 0)
+    {
+        return -ERANGE;
+    }
+    
+    //Vobj - Vos, Q16
+    const int64_t vos = (cal->b0 >> 16) + ((cal->b1 * t) >> 21) + ((cal->b2 * t2) >> 26);
+    const int64_t d = (int64_t)voltage * 65536 - vos;
+    
+    //f(Vobj) = d + c2 * d^2, Q16
+    const int64_t c2d = (cal->c2 * (d >> 8)) >> 32; //Q24
+    const int64_t f = d + ((c2d * d) >> 24);
+    
+    //f / S in K^4, Q4, small S near the zero of its polynomial makes the quotient overflow
+    if ((f > (INT64_MAX >> 30)) || (f < -(INT64_MAX >> 30)))
+    {
+        return -ERANGE;
+    }
+    const int64_t g = (f * ((int64_t)1 << 30)) / sFactor;
+    const int64_t invS0Abs = (cal->invS0 < 0) ? -cal->invS0 : cal->invS0;
+    if ((invS0Abs != 0) && ((g > (INT64_MAX / invS0Abs)) || (g < -(INT64_MAX / invS0Abs))))
+    {
+        return -ERANGE;
+    }
+    const int64_t h = (g * cal->invS0) >> 16;
+    
+    //Tdie^4 in K^4, Q4
+    const int64_t tDie = (int64_t)temperature * 32 + TMP006_ZERO_CELSIUS_Q10; //Q10
+    const int64_t tDie2 = (tDie * tDie) >> 12; //Q8
+    const int64_t tDie4 = (tDie2 * tDie2) >> 12; //Q4
+    
+    const int64_t tObj4 = tDie4 + h;
+    if ((tObj4 <= 0) || (tObj4 > TMP006_TOBJ4_MAX))
+    {
+        return -ERANGE;
+    }
+    
+    //fourth root of Q24 gives Q6, remaining bits are interpolated up to Q10
+    const uint64_t x = (uint64_t)tObj4 << 20;
+    const uint64_t r = tmp006_root4(x);
+    const uint64_t r4 = r * r * r * r;
+    const uint64_t rNext4 = (r + 1) * (r + 1) * (r + 1) * (r + 1);
+    const int64_t tObjK = (int64_t)((r * 16) + (((x - r4) * 16) / (rNext4 - r4)));
+    
+    //Q10 kelvin to Q5 celsius, rounded
+    const int64_t result = ((tObjK - TMP006_ZERO_CELSIUS_Q10) + 16) >> 5;
+    if ((result > INT16_MAX) || (result < INT16_MIN))
+    {
+        return -ERANGE;
+    }
+    
+    *tobj = (int16_t)result;
+    
+    return 0;
+}
+
+/**
+* @brief Interpolate object temperature from lookup table
+*
+* @returns 0 on success, -ERANGE if inputs are not covered by valid part of the table
+*/
+static int lookupTable(const TMP006_TobjTable *table, int16_t voltage, int16_t temperature, int16_t *tobj)
+{
+    if ((temperature < TMP006_TABLE_TDIE_MIN) || (temperature > TMP006_TABLE_TDIE_MAX))
+    {
+        return -ERANGE;
+    }
+    
+    const uint32_t t = (uint32_t)(temperature - TMP006_TABLE_TDIE_MIN);
+    const uint32_t v = (uint32_t)(voltage - INT16_MIN);
+    const uint32_t tFrac = t & ((1UL << table->tShift) - 1);
+    const uint32_t vFrac = v & ((1UL << table->vShift) - 1);
+    
+    const int16_t *q0 = &table->values[(t >> table->tShift) * table->vCount + (v >> table->vShift)];
+    const int16_t *q1 = q0 + table->vCount;
+    if ((q0[0] == TMP006_TOBJ_INVALID) || (q0[1] == TMP006_TOBJ_INVALID) ||
+        (q1[0] == TMP006_TOBJ_INVALID) || (q1[1] == TMP006_TOBJ_INVALID))
+    {
+        return -ERANGE;
+    }
+    
+    const int64_t tWeight = (int64_t)1 << table->tShift;
+    const int64_t vWeight = (int64_t)1 << table->vShift;
+    const int64_t sum = ((int64_t)q0[0] * (vWeight - vFrac) + (int64_t)q0[1] * vFrac) * (tWeight - tFrac) +
+                        ((int64_t)q1[0] * (vWeight - vFrac) + (int64_t)q1[1] * vFrac) * tFrac;
+    const uint8_t shift = table->tShift + table->vShift;
+    
+    *tobj = (int16_t)((sum + ((int64_t)1 << (shift - 1))) >> shift);
+    
+    return 0;
+}
+
+int tmp006_computeTobj(const TMP006_Calibration *cal, int16_t voltage, int16_t temperature, int16_t *tobj)
+{
+    TMP006_CHECK_PARAM((cal == NULL) || (tobj == NULL));
+    
+    if ((cal->table != NULL) && (lookupTable(cal->table, voltage, temperature, tobj) == 0))
+    {
+        return 0;
+    }
+    
+    return computeExact(cal, voltage, temperature, tobj);
+}
+
+/**
+* @brief Bound of difference between interpolated and exact result in one cell of table
+*
+* Error is measured on a grid of TMP006_TABLE_CHECK_STEPS x TMP006_TABLE_CHECK_STEPS subcells.
+* Between the points it can grow by at most the error of linear interpolation of exact result
+* over a subcell, which is 1/8 of its second difference along each axis.
+*
+* @returns bound in LSB, 0 if no result of the cell is in range checked by the table
+*/
+static uint16_t cellErrorBound(const TMP006_Calibration *cal, int32_t voltage, int32_t temperature)
+{
+    const TMP006_TobjTable *table = cal->table;
+    const int32_t tSub = (1L << table->tShift) / TMP006_TABLE_CHECK_STEPS;
+    const int32_t vSub = (1L << table->vShift) / TMP006_TABLE_CHECK_STEPS;
+    int16_t exact[TMP006_TABLE_CHECK_STEPS + 1][TMP006_TABLE_CHECK_STEPS + 1];
+    int32_t error[TMP006_TABLE_CHECK_STEPS + 1][TMP006_TABLE_CHECK_STEPS + 1];
+    
+    for (uint8_t a = 0; a <= TMP006_TABLE_CHECK_STEPS; a++)
+    {
+        for (uint8_t b = 0; b <= TMP006_TABLE_CHECK_STEPS; b++)
+        {
+            //last column of the table is at 32768, it holds result of 32767
+            const int32_t t = temperature + (a * tSub);
+            int32_t v = voltage + (b * vSub);
+            v = (v > INT16_MAX) ? INT16_MAX : v;
+            
+            int16_t interpolated;
+            if ((t > TMP006_TABLE_TDIE_MAX) ||
+                (computeExact(cal, (int16_t)v, (int16_t)t, &exact[a][b]) != 0) ||
+                (lookupTable(table, (int16_t)v, (int16_t)t, &interpolated) != 0))
+            {
+                exact[a][b] = TMP006_TOBJ_INVALID;
+                continue;
+            }
+            error[a][b] = (int32_t)exact[a][b] - interpolated;
+            error[a][b] = (error[a][b] < 0) ? -error[a][b] : error[a][b];
+        }
+    }
+    
+    uint16_t bound = 0;
+    for (uint8_t a = 0; a < TMP006_TABLE_CHECK_STEPS; a++)
+    {
+        for (uint8_t b = 0; b < TMP006_TABLE_CHECK_STEPS; b++)
+        {
+            //result grows with voltage and die temperature, corners give its range in subcell
+            if ((exact[a][b] == TMP006_TOBJ_INVALID) || (exact[a][b + 1] == TMP006_TOBJ_INVALID) ||
+                (exact[a + 1][b] == TMP006_TOBJ_INVALID) || (exact[a + 1][b + 1] == TMP006_TOBJ_INVALID) ||
+                (exact[a + 1][b + 1] < TMP006_TABLE_TOBJ_MIN) || (exact[a][b] > TMP006_TABLE_TOBJ_MAX))
+            {
+                continue;
+            }
+            
+            int32_t corner = 0;
+            int32_t vCurve = 0;
+            int32_t tCurve = 0;
+            for (uint8_t k = 0; k < 2; k++)
+            {
+                corner = (error[a + k][b] > corner) ? error[a + k][b] : corner;
+                corner = (error[a + k][b + 1] > corner) ? error[a + k][b + 1] : corner;
+                
+                //second differences centered on both ends of subcell, where neighbour points exist
+                for (uint8_t m = 0; m < 2; m++)
+                {
+                    const uint8_t c = (uint8_t)(b + m);
+                    if ((c > 0) && (c < TMP006_TABLE_CHECK_STEPS) &&
+                        (exact[a + k][c - 1] != TMP006_TOBJ_INVALID) && (exact[a + k][c + 1] != TMP006_TOBJ_INVALID))
+                    {
+                        int32_t d = exact[a + k][c - 1] - (2 * exact[a + k][c]) + exact[a + k][c + 1];
+                        d = (d < 0) ? -d : d;
+                        vCurve = (d > vCurve) ? d : vCurve;
+                    }
+                    const uint8_t r = (uint8_t)(a + m);
+                    if ((r > 0) && (r < TMP006_TABLE_CHECK_STEPS) &&
+                        (exact[r - 1][b + k] != TMP006_TOBJ_INVALID) && (exact[r + 1][b + k] != TMP006_TOBJ_INVALID))
+                    {
+                        int32_t d = exact[r - 1][b + k] - (2 * exact[r][b + k]) + exact[r + 1][b + k];
+                        d = (d < 0) ? -d : d;
+                        tCurve = (d > tCurve) ? d : tCurve;
+                    }
+                }
+            }
+            
+            //results and grid points are rounded, which adds up to 2 LSB between the points
+            const int32_t subBound = corner + ((vCurve + tCurve + 7) / 8) + 2;
+            bound = (subBound > bound) ? (uint16_t)subBound : bound;
+        }
+    }
+    
+    return bound;
+}
+
+int tmp006_buildTobjTable(TMP006_Calibration *cal, TMP006_TobjTable *table, int16_t *buffer, size_t bufferSize)
+{
+    TMP006_CHECK_PARAM(cal == NULL);
+    
+    cal->table = NULL;
+    if (table == NULL)
+    {
+        return 0;
+    }
+    TMP006_CHECK_PARAM(buffer == NULL);
+    
+    //find the finest grid that fits, voltage spacing is kept 4x coarser than temperature
+    uint8_t tShift = TMP006_TABLE_TSHIFT_MIN;
+    uint8_t vShift = TMP006_TABLE_VSHIFT_MIN;
+    while (1)
+    {
+        //one extra point so that the last cell has its upper corners
+        const size_t tCount = (size_t)((TMP006_TABLE_TDIE_MAX - TMP006_TABLE_TDIE_MIN) >> tShift) + 2;
+        const size_t vCount = (size_t)(UINT16_MAX >> vShift) + 2;
+        if ((tCount * vCount * sizeof(int16_t)) <= bufferSize)
+        {
+            table->tCount = (uint16_t)tCount;
+            table->vCount = (uint16_t)vCount;
+            break;
+        }
+        
+        if ((vShift < TMP006_TABLE_VSHIFT_MAX) && ((vShift - tShift) < 2))
+        {
+            vShift++;
+        }
+        else if (tShift < TMP006_TABLE_TSHIFT_MAX)
+        {
+            tShift++;
+        }
+        else if (vShift < TMP006_TABLE_VSHIFT_MAX)
+        {
+            vShift++;
+        }
+        else
+        {
+            return -ENOMEM;
+        }
+    }
+    
+    table->values = buffer;
+    table->tShift = tShift;
+    table->vShift = vShift;
+    table->errorEstimate = 0;
+    
+    for (uint32_t i = 0; i < table->tCount; i++)
+    {
+        for (uint32_t j = 0; j < table->vCount; j++)
+        {
+            //last column is at voltage 32768 which doesn't fit, it holds result of 32767
+            //and is used with almost full weight by the top voltages of the last cell
+            const int32_t t = TMP006_TABLE_TDIE_MIN + (int32_t)(i << tShift);
+            int32_t v = INT16_MIN + (int32_t)(j << vShift);
+            v = (v > INT16_MAX) ? INT16_MAX : v;
+            
+            int16_t *value = &buffer[i * table->vCount + j];
+            if (computeExact(cal, (int16_t)v, (int16_t)t, value) != 0)
+            {
+                *value = TMP006_TOBJ_INVALID;
+            }
+        }
+    }
+    
+    cal->table = table;
+    
+    for (uint32_t i = 0; i < (uint32_t)(table->tCount - 1); i++)
+    {
+        for (uint32_t j = 0; j < (uint32_t)(table->vCount - 1); j++)
+        {
+            const uint16_t bound = cellErrorBound(cal, INT16_MIN + (int32_t)(j << vShift),
+                                                  TMP006_TABLE_TDIE_MIN + (int32_t)(i << tShift));
+            table->errorEstimate = (bound > table->errorEstimate) ? bound : table->errorEstimate;
+        }
+    }
+    
+    return 0;
+}
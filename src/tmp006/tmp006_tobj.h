@@ -0,0 +1,207 @@
+/**
+* @file tmp006_tobj.h
+* @brief Object temperature calculation for TI TMP006, integer only
+*
+* Implements the model from TMP006 User's Guide (SBOU107):
+*
+*     S    = S0 * (1 + a1 * (Tdie - Tref) + a2 * (Tdie - Tref)^2)
+*     Vos  = b0 + b1 * (Tdie - Tref) + b2 * (Tdie - Tref)^2
+*     f    = (Vobj - Vos) + c2 * (Vobj - Vos)^2
+*     Tobj = (Tdie^4 + f / S)^(1/4)
+*
+* using only 64-bit integer arithmetic, so it can be used on parts without FPU.
+*
+* @author Zarko Milojicic
+*/
+
+#ifndef TMP006_TOBJ_H
+#define TMP006_TOBJ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Reference temperature of the model (25 C) in 1/32 C */
+#define TMP006_TREF                     800
+
+/** @brief 0 C in kelvin, multiplied by 1024 */
+#define TMP006_ZERO_CELSIUS_Q10         279706
+
+/** @brief Value stored by tmp006_computeTobjBatch() for samples out of range */
+#define TMP006_TOBJ_INVALID             INT16_MIN
+
+/** @brief Size of one LSB of VOBJECT register in volts */
+#define TMP006_VOBJECT_LSB              156.25e-9
+
+/**
+* @brief Helper macro for conversion of floating point constant to fixed point
+* @note Used only in constant expressions, no floating point code is generated.
+*/
+#define TMP006_TO_FIXED(value, scale)   \
+    ((int64_t)(((value) * (scale)) + (((value) >= 0) ? 0.5 : -0.5)))
+
+/** @brief Range of die temperatures covered by lookup table, in 1/32 C */
+#define TMP006_TABLE_TDIE_MIN           (-1600)
+#define TMP006_TABLE_TDIE_MAX           4800
+
+/** @brief Range of object temperatures in which error of lookup table is checked, in 1/32 C */
+#define TMP006_TABLE_TOBJ_MIN           (-1280)
+#define TMP006_TABLE_TOBJ_MAX           6400
+
+struct TMP006_TobjTable;
+
+/**
+* @brief Calibration coefficients in fixed point format
+*
+* Voltages are expressed in LSB of VOBJECT register (156.25 nV), temperatures in kelvin.
+* Use TMP006_CALIBRATION() to fill the structure from coefficients in SI units.
+*/
+typedef struct TMP006_Calibration
+{
+    int64_t invS0; /**< VOBJECT LSB / S0 [K^4/LSB], Q4 */
+    int64_t a1;    /**< a1 [1/K], Q40 */
+    int64_t a2;    /**< a2 [1/K^2], Q40 */
+    int64_t b0;    /**< b0 [LSB], Q32 */
+    int64_t b1;    /**< b1 [LSB/K], Q32 */
+    int64_t b2;    /**< b2 [LSB/K^2], Q32 */
+    int64_t c2;    /**< c2 [1/LSB], Q48 */
+    
+    const struct TMP006_TobjTable *table; /**< Optional lookup table, set by tmp006_buildTobjTable() */
+} TMP006_Calibration;
+
+/**
+* @brief Lookup table of object temperatures
+*
+* Grid of exact results indexed by die temperature and voltage, spaced by powers of two.
+* Values between grid points are bilinearly interpolated.
+*/
+typedef struct TMP006_TobjTable
+{
+    int16_t *values;   /**< Grid of object temperatures, tCount rows of vCount values */
+    uint16_t tCount;   /**< Number of die temperature points */
+    uint16_t vCount;   /**< Number of voltage points */
+    uint8_t  tShift;   /**< Spacing of die temperature points is 2^tShift */
+    uint8_t  vShift;   /**< Spacing of voltage points is 2^vShift */
+    uint16_t errorEstimate; /**< Bound of difference from exact result, found while building, LSB = 1/32 C */
+} TMP006_TobjTable;
+
+/**
+* @brief Initializer of TMP006_Calibration from coefficients in SI units
+*
+* @param S0 Sensitivity [V/K^4], typically 5e-14 to 7e-14
+* @param A1 a1 [1/K]
+* @param A2 a2 [1/K^2]
+* @param B0 b0 [V]
+* @param B1 b1 [V/K]
+* @param B2 b2 [V/K^2]
+* @param C2 c2 [1/V]
+*/
+#define TMP006_CALIBRATION(S0, A1, A2, B0, B1, B2, C2)                       \
+    {                                                                        \
+        .invS0 = TMP006_TO_FIXED(TMP006_VOBJECT_LSB / (S0), 16.0),           \
+        .a1    = TMP006_TO_FIXED((A1), 1099511627776.0),                     \
+        .a2    = TMP006_TO_FIXED((A2), 1099511627776.0),                     \
+        .b0    = TMP006_TO_FIXED((B0) / TMP006_VOBJECT_LSB, 4294967296.0),   \
+        .b1    = TMP006_TO_FIXED((B1) / TMP006_VOBJECT_LSB, 4294967296.0),   \
+        .b2    = TMP006_TO_FIXED((B2) / TMP006_VOBJECT_LSB, 4294967296.0),   \
+        .c2    = TMP006_TO_FIXED((C2) * TMP006_VOBJECT_LSB, 281474976710656.0) \
+    }
+
+/**
+* @brief Calibration with typical coefficients from the User's Guide
+*/
+#define TMP006_CALIBRATION_DEFAULT \
+    TMP006_CALIBRATION(6.4e-14, 1.75e-3, -1.678e-5, -2.94e-5, -5.7e-7, 4.63e-9, 13.4)
+
+/**
+* @brief Integer fourth root
+*
+* Newton iteration r = (3r + x / r^3) / 4, started above the root.
+*
+* @param x Input value
+* @returns floor(x^(1/4))
+*/
+uint32_t tmp006_root4(uint64_t x);
+
+/**
+* @brief Calculate object temperature.
+*
+* @param[in] cal Pointer to calibration coefficients
+* @param[in] voltage Sensor voltage, as returned by tmp006_readVoltage()
+* @param[in] temperature Die temperature, as returned by tmp006_readTemp()
+* @param[out] tobj Object temperature, LSB = 1/32 C
+*
+* @returns 0 on success or an error code
+* @returns -ERANGE if the result is out of range of the model or of int16_t
+*
+* If lookup table is attached to calibration, result is interpolated from it.
+* Exact calculation is used for inputs not covered by the table.
+*
+* @note With TMP006_CALIBRATION_DEFAULT, over whole range of die temperature
+* and voltages giving object temperature from -40 C to +200 C, the result differs
+* from double precision reference by less than 0.6 LSB (0.02 C), 0.5 LSB of which
+* is rounding of the output.
+*/
+int tmp006_computeTobj(const TMP006_Calibration *cal, int16_t voltage, int16_t temperature, int16_t *tobj);
+
+/**
+* @brief Build lookup table and attach it to calibration.
+*
+* Spacing of the grid is chosen as fine as buffer allows. Table covers die temperatures
+* from TMP006_TABLE_TDIE_MIN to TMP006_TABLE_TDIE_MAX and the whole range of voltages.
+* After the table is built every cell is checked against exact calculation on a 5 x 5
+* grid of points. Difference between the points is bounded by second differences of
+* exact results, the largest bound for results from TMP006_TABLE_TOBJ_MIN to
+* TMP006_TABLE_TOBJ_MAX is stored in errorEstimate.
+*
+* With TMP006_CALIBRATION_DEFAULT the bound and the real worst case, found by checking
+* every input, are 949 and 649 LSB for 2 kB buffer, 173 and 100 LSB for 8 kB,
+* 80 and 54 LSB for 16 kB, 18 and 14 LSB for 64 kB and 7 and 4 LSB for 256 kB.
+*
+* @param[in,out] cal Pointer to calibration coefficients, table is attached to it
+* @param[out] table Pointer to table structure
+* @param[in] buffer Memory for table values
+* @param[in] bufferSize Size of buffer in bytes
+*
+* @returns 0 on success or an error code
+* @returns -ENOMEM if buffer can't hold even the coarsest table
+*
+* @note Building needs one exact calculation per grid point and 25 per cell,
+* so it should be done at init. Passing NULL as table detaches the table from cal.
+*/
+int tmp006_buildTobjTable(TMP006_Calibration *cal, TMP006_TobjTable *table, int16_t *buffer, size_t bufferSize);
+
+/**
+* @brief Calculate object temperature for array of samples.
+*
+* Inputs are separate arrays of voltages and die temperatures (struct of arrays).
+* On x86 hosts AVX2 or SSE2 kernel is selected at first call, depending on CPU,
+* otherwise samples are calculated one by one with tmp006_computeTobj().
+*
+* @param[in] cal Pointer to calibration coefficients
+* @param[in] voltage Array of sensor voltages, as returned by tmp006_readVoltage()
+* @param[in] temperature Array of die temperatures, as returned by tmp006_readTemp()
+* @param[out] tobj Array of object temperatures, LSB = 1/32 C
+* @param[in] count Number of samples
+*
+* @returns 0 on success or an error code
+* @returns -ERANGE if some of samples are out of range, those are set to TMP006_TOBJ_INVALID
+*
+* @note SIMD kernels evaluate the model in double precision. In the range documented
+* for tmp006_computeTobj() they differ from it by at most 1 LSB (1/32 C). AVX2 kernel
+* calculates more than 50 million samples per second on one core of desktop CPU.
+*/
+int tmp006_computeTobjBatch(const TMP006_Calibration *cal,
+                            const int16_t *voltage,
+                            const int16_t *temperature,
+                            int16_t *tobj,
+                            size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TMP006_TOBJ_H
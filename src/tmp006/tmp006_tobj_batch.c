@@ -0,0 +1,260 @@
+/**
+* @file tmp006_tobj_batch.c
+* @brief Object temperature calculation for arrays of samples
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006_tobj.h"
+
+#include <errno.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TMP006_TOBJ_SIMD
+#include <immintrin.h>
+#endif
+
+/*
+* Helper macro for parametar checking
+*/
+#define TMP006_CHECK_PARAM(expr) \
+    do                           \
+    {                            \
+        if (expr)                \
+        {                        \
+            return -EINVAL;      \
+        }                        \
+    } while (0)
+
+/**
+* @brief Kernel that calculates count samples, returns number of invalid samples
+*/
+typedef size_t (*TMP006_TobjKernel)(const TMP006_Calibration *cal,
+                                    const int16_t *voltage,
+                                    const int16_t *temperature,
+                                    int16_t *tobj,
+                                    size_t count);
+
+static size_t computeScalar(const TMP006_Calibration *cal,
+                            const int16_t *voltage,
+                            const int16_t *temperature,
+                            int16_t *tobj,
+                            size_t count)
+{
+    size_t invalid = 0;
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tmp006_computeTobj(cal, voltage[i], temperature[i], &tobj[i]) != 0)
+        {
+            tobj[i] = TMP006_TOBJ_INVALID;
+            invalid++;
+        }
+    }
+    
+    return invalid;
+}
+
+#ifdef TMP006_TOBJ_SIMD
+
+/**
+* @brief Calibration coefficients in double precision, same units as TMP006_Calibration
+*/
+typedef struct
+{
+    double invS0;
+    double a1, a2;
+    double b0, b1, b2;
+    double c2;
+} CalibrationF64;
+
+static void toDouble(const TMP006_Calibration *cal, CalibrationF64 *out)
+{
+    out->invS0 = (double)cal->invS0 / 16.0;
+    out->a1 = (double)cal->a1 / 1099511627776.0;
+    out->a2 = (double)cal->a2 / 1099511627776.0;
+    out->b0 = (double)cal->b0 / 4294967296.0;
+    out->b1 = (double)cal->b1 / 4294967296.0;
+    out->b2 = (double)cal->b2 / 4294967296.0;
+    out->c2 = (double)cal->c2 / 281474976710656.0;
+}
+
+/** @brief Object temperature limits in 1/32 C, everything else is invalid */
+#define TOBJ_MIN    ((double)INT16_MIN + 1.0)
+#define TOBJ_MAX    ((double)INT16_MAX)
+
+__attribute__((target("sse2")))
+static size_t computeSse2(const TMP006_Calibration *cal,
+                          const int16_t *voltage,
+                          const int16_t *temperature,
+                          int16_t *tobj,
+                          size_t count)
+{
+    CalibrationF64 c;
+    toDouble(cal, &c);
+    
+    const __m128d invS0 = _mm_set1_pd(c.invS0);
+    const __m128d a1 = _mm_set1_pd(c.a1), a2 = _mm_set1_pd(c.a2);
+    const __m128d b0 = _mm_set1_pd(c.b0), b1 = _mm_set1_pd(c.b1), b2 = _mm_set1_pd(c.b2);
+    const __m128d c2 = _mm_set1_pd(c.c2);
+    const __m128d one = _mm_set1_pd(1.0), zero = _mm_setzero_pd();
+    const __m128d lsb = _mm_set1_pd(1.0 / 32.0), scale = _mm_set1_pd(32.0);
+    const __m128d tRef = _mm_set1_pd(25.0), zeroC = _mm_set1_pd(273.15);
+    const __m128d tMin = _mm_set1_pd(TOBJ_MIN), tMax = _mm_set1_pd(TOBJ_MAX);
+    
+    size_t invalid = 0;
+    size_t i = 0;
+    for (; (i + 2) <= count; i += 2)
+    {
+        const __m128d v = _mm_set_pd(voltage[i + 1], voltage[i]);
+        const __m128d tC = _mm_mul_pd(_mm_set_pd(temperature[i + 1], temperature[i]), lsb);
+        const __m128d t = _mm_sub_pd(tC, tRef);
+        const __m128d t2 = _mm_mul_pd(t, t);
+        
+        const __m128d sFactor = _mm_add_pd(_mm_add_pd(one, _mm_mul_pd(a1, t)), _mm_mul_pd(a2, t2));
+        const __m128d vos = _mm_add_pd(_mm_add_pd(b0, _mm_mul_pd(b1, t)), _mm_mul_pd(b2, t2));
+        const __m128d d = _mm_sub_pd(v, vos);
+        const __m128d f = _mm_add_pd(d, _mm_mul_pd(c2, _mm_mul_pd(d, d)));
+        
+        const __m128d tDie = _mm_add_pd(tC, zeroC);
+        const __m128d tDie2 = _mm_mul_pd(tDie, tDie);
+        const __m128d x = _mm_add_pd(_mm_mul_pd(tDie2, tDie2), _mm_div_pd(_mm_mul_pd(f, invS0), sFactor));
+        
+        const __m128d tObj = _mm_mul_pd(_mm_sub_pd(_mm_sqrt_pd(_mm_sqrt_pd(x)), zeroC), scale);
+        
+        //NaN fails all ordered comparisons, so it is invalid too
+        const __m128d ok = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(sFactor, zero), _mm_cmpgt_pd(x, zero)),
+                                      _mm_and_pd(_mm_cmpge_pd(tObj, tMin), _mm_cmple_pd(tObj, tMax)));
+        const int okMask = _mm_movemask_pd(ok);
+        
+        int32_t out[4];
+        _mm_storeu_si128((__m128i *)out, _mm_cvtpd_epi32(_mm_and_pd(tObj, ok)));
+        for (int k = 0; k < 2; k++)
+        {
+            if (okMask & (1 << k))
+            {
+                tobj[i + k] = (int16_t)out[k];
+            }
+            else
+            {
+                tobj[i + k] = TMP006_TOBJ_INVALID;
+                invalid++;
+            }
+        }
+    }
+    
+    return invalid + computeScalar(cal, &voltage[i], &temperature[i], &tobj[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static size_t computeAvx2(const TMP006_Calibration *cal,
+                          const int16_t *voltage,
+                          const int16_t *temperature,
+                          int16_t *tobj,
+                          size_t count)
+{
+    CalibrationF64 c;
+    toDouble(cal, &c);
+    
+    const __m256d invS0 = _mm256_set1_pd(c.invS0);
+    const __m256d a1 = _mm256_set1_pd(c.a1), a2 = _mm256_set1_pd(c.a2);
+    const __m256d b0 = _mm256_set1_pd(c.b0), b1 = _mm256_set1_pd(c.b1), b2 = _mm256_set1_pd(c.b2);
+    const __m256d c2 = _mm256_set1_pd(c.c2);
+    const __m256d one = _mm256_set1_pd(1.0), zero = _mm256_setzero_pd();
+    const __m256d lsb = _mm256_set1_pd(1.0 / 32.0), scale = _mm256_set1_pd(32.0);
+    const __m256d tRef = _mm256_set1_pd(25.0), zeroC = _mm256_set1_pd(273.15);
+    const __m256d tMin = _mm256_set1_pd(TOBJ_MIN), tMax = _mm256_set1_pd(TOBJ_MAX);
+    
+    size_t invalid = 0;
+    size_t i = 0;
+    for (; (i + 4) <= count; i += 4)
+    {
+        const __m256d v = _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)&voltage[i])));
+        const __m256d tC = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)&temperature[i]))), lsb);
+        const __m256d t = _mm256_sub_pd(tC, tRef);
+        const __m256d t2 = _mm256_mul_pd(t, t);
+        
+        const __m256d sFactor = _mm256_add_pd(_mm256_add_pd(one, _mm256_mul_pd(a1, t)), _mm256_mul_pd(a2, t2));
+        const __m256d vos = _mm256_add_pd(_mm256_add_pd(b0, _mm256_mul_pd(b1, t)), _mm256_mul_pd(b2, t2));
+        const __m256d d = _mm256_sub_pd(v, vos);
+        const __m256d f = _mm256_add_pd(d, _mm256_mul_pd(c2, _mm256_mul_pd(d, d)));
+        
+        const __m256d tDie = _mm256_add_pd(tC, zeroC);
+        const __m256d tDie2 = _mm256_mul_pd(tDie, tDie);
+        const __m256d x = _mm256_add_pd(_mm256_mul_pd(tDie2, tDie2), _mm256_div_pd(_mm256_mul_pd(f, invS0), sFactor));
+        
+        const __m256d tObj = _mm256_mul_pd(_mm256_sub_pd(_mm256_sqrt_pd(_mm256_sqrt_pd(x)), zeroC), scale);
+        
+        //NaN fails all ordered comparisons, so it is invalid too
+        const __m256d ok = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(sFactor, zero, _CMP_GT_OQ),
+                                                       _mm256_cmp_pd(x, zero, _CMP_GT_OQ)),
+                                         _mm256_and_pd(_mm256_cmp_pd(tObj, tMin, _CMP_GE_OQ),
+                                                       _mm256_cmp_pd(tObj, tMax, _CMP_LE_OQ)));
+        const int okMask = _mm256_movemask_pd(ok);
+        
+        const __m128i out = _mm256_cvtpd_epi32(_mm256_and_pd(tObj, ok));
+        _mm_storel_epi64((__m128i *)&tobj[i], _mm_packs_epi32(out, out));
+        if (okMask != 0xF)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                if (!(okMask & (1 << k)))
+                {
+                    tobj[i + k] = TMP006_TOBJ_INVALID;
+                    invalid++;
+                }
+            }
+        }
+    }
+    
+    return invalid + computeScalar(cal, &voltage[i], &temperature[i], &tobj[i], count - i);
+}
+
+/**
+* @brief Select the fastest kernel supported by CPU
+*/
+static TMP006_TobjKernel selectKernel(void)
+{
+    __builtin_cpu_init();
+    
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return computeAvx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return computeSse2;
+    }
+    
+    return computeScalar;
+}
+
+#else
+
+static TMP006_TobjKernel selectKernel(void)
+{
+    return computeScalar;
+}
+
+#endif //TMP006_TOBJ_SIMD
+
+int tmp006_computeTobjBatch(const TMP006_Calibration *cal,
+                            const int16_t *voltage,
+                            const int16_t *temperature,
+                            int16_t *tobj,
+                            size_t count)
+{
+    static TMP006_TobjKernel kernel = NULL;
+    
+    TMP006_CHECK_PARAM((cal == NULL) || (voltage == NULL) || (temperature == NULL) || (tobj == NULL));
+    
+    if (kernel == NULL)
+    {
+        kernel = selectKernel();
+    }
+    
+    //lookup table is used only by scalar path
+    const TMP006_TobjKernel selected = (cal->table != NULL) ? computeScalar : kernel;
+    
+    return (selected(cal, voltage, temperature, tobj, count) == 0) ? 0 : -ERANGE;
+}
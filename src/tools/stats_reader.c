@@ -0,0 +1,59 @@
+/**
+* @file stats_reader.c
+* @brief Host tool which reads TMP006 statistics dump from console log
+*
+* Log is read from standard input, the last dump in it is summarized.
+* Build on host, e.g.
+* gcc -std=gnu99 -DTMP006_STATS -Isrc src/tools/stats_reader.c src/tmp006/tmp006_stats.c
+*     -o stats_reader
+* and run as stats_reader < uart.log
+*
+* @author Zarko Milojicic
+*/
+
+#include "tmp006/tmp006_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int main(void)
+{
+    TMP006_Stats stats;
+    char line[512];
+    bool found = false;
+
+    memset(&stats, 0, sizeof(stats));
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        //bus line starts a new dump, calls without calls aren't printed in it
+        if (strstr(line, "tmp006 stats bus ") != NULL)
+        {
+            memset(&stats, 0, sizeof(stats));
+        }
+        found |= tmp006_statsParseLine(&stats, line);
+    }
+
+    if (!found)
+    {
+        fprintf(stderr, "no statistics in input\n");
+        return 1;
+    }
+
+    printf("bus: %u transactions, %u bytes, %u errors, %u retries\n",
+           stats.transactions, stats.bytes, stats.errors, stats.retries);
+    printf("%-14s %8s %8s %8s %6s %10s %10s %10s\n", "call", "calls", "txns", "bytes", "errors", "p50 ns", "p99 ns", "max ns");
+    for (uint8_t call = 0; call < TMP006_STATS_CALL_COUNT; call++)
+    {
+        const TMP006_CallStats *entry = &stats.call[call];
+        if (entry->calls == 0)
+        {
+            continue;
+        }
+
+        printf("%-14s %8u %8u %8u %6u %10u %10u %10u\n", tmp006_statsCallName(call), entry->calls, entry->transactions,
+               entry->bytes, entry->errors, tmp006_statsPercentile(entry, 50),
+               tmp006_statsPercentile(entry, 99), entry->maxNs);
+    }
+
+    return 0;
+}